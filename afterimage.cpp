@@ -14,24 +14,63 @@ void initPlayerAfterImage(DreamPlayer* p)
 {
 	p->mAfterImage.mIsActive = 0;
 	p->mAfterImage.mHistoryBuffer.clear();
+	p->mAfterImage.mHistoryBufferStart = 0;
+	p->mAfterImage.mHistoryBufferAmount = 0;
+	p->mAfterImage.mSpriteAnimations.clear();
 }
 
-static void addHistoryBufferElement(DreamPlayer* tPlayer) {
+static MugenAnimation* getAfterImageSpriteAnimation(DreamPlayerAfterImage& tAfterImage, int tSpriteGroup, int tSpriteItem) {
+	const auto key = std::make_pair(tSpriteGroup, tSpriteItem);
+	const auto it = tAfterImage.mSpriteAnimations.find(key);
+	if (it != tAfterImage.mSpriteAnimations.end()) return it->second;
+
+	MugenAnimation* animation = createOneFrameMugenAnimationForSprite(tSpriteGroup, tSpriteItem);
+	tAfterImage.mSpriteAnimations[key] = animation;
+	return animation;
+}
+
+static AfterImageHistoryBufferEntry* acquireHistoryBufferSlot(DreamPlayer* tPlayer, MugenAnimation* tAnimation, const Position& tPosition) {
 	DreamPlayerAfterImage& afterImage = tPlayer->mAfterImage;
+	const auto size = int(afterImage.mHistoryBuffer.size());
+	if (afterImage.mHistoryBufferAmount < size) {
+		afterImage.mHistoryBufferStart = (afterImage.mHistoryBufferStart + size - 1) % size;
+		afterImage.mHistoryBufferAmount++;
+		auto e = &afterImage.mHistoryBuffer[afterImage.mHistoryBufferStart];
+		if (e->mAnimation != tAnimation) {
+			changeMugenAnimation(e->mAnimationElement, tAnimation);
+			e->mAnimation = tAnimation;
+		}
+		setMugenAnimationPosition(e->mAnimationElement, tPosition);
+		return e;
+	}
+
+	std::rotate(afterImage.mHistoryBuffer.begin(), afterImage.mHistoryBuffer.begin() + afterImage.mHistoryBufferStart, afterImage.mHistoryBuffer.end());
 	AfterImageHistoryBufferEntry e;
-	const auto sprite = getMugenAnimationSprite(tPlayer->mAnimationElement);
-	e.mAnimation = createOneFrameMugenAnimationForSprite(sprite.x, sprite.y);
-	const auto p = getDreamStageCoordinateSystemOffset(getDreamMugenStageHandlerCameraCoordinateP()) + getHandledPhysicsPosition(tPlayer->mPhysicsElement).xy();
-	e.mAnimationElement = addMugenAnimation(e.mAnimation, &tPlayer->mHeader->mFiles.mSprites, p.xyz(PLAYER_Z));
-	setMugenAnimationDrawScale(e.mAnimationElement, Vector2D(getPlayerScaleX(tPlayer), getPlayerScaleY(tPlayer)) * tPlayer->mTempScale * getPlayerToCameraScale(tPlayer));
+	e.mAnimation = tAnimation;
+	e.mAnimationElement = addMugenAnimation(tAnimation, &tPlayer->mHeader->mFiles.mSprites, tPosition);
 	setMugenAnimationCameraPositionReference(e.mAnimationElement, getDreamMugenStageHandlerCameraPositionReference());
 	setMugenAnimationCameraEffectPositionReference(e.mAnimationElement, getDreamMugenStageHandlerCameraEffectPositionReference());
 	setMugenAnimationCameraScaleReference(e.mAnimationElement, getDreamMugenStageHandlerCameraZoomReference());
+	afterImage.mHistoryBuffer.push_back(e);
+	afterImage.mHistoryBufferStart = size;
+	afterImage.mHistoryBufferAmount++;
+	return &afterImage.mHistoryBuffer.back();
+}
+
+static AfterImageHistoryBufferEntry& getHistoryBufferEntry(DreamPlayerAfterImage& tAfterImage, int tIndex) {
+	return tAfterImage.mHistoryBuffer[(tAfterImage.mHistoryBufferStart + tIndex) % int(tAfterImage.mHistoryBuffer.size())];
+}
+
+static void addHistoryBufferElement(DreamPlayer* tPlayer) {
+	DreamPlayerAfterImage& afterImage = tPlayer->mAfterImage;
+	const auto sprite = getMugenAnimationSprite(tPlayer->mAnimationElement);
+	MugenAnimation* animation = getAfterImageSpriteAnimation(afterImage, sprite.x, sprite.y);
+	const auto p = getDreamStageCoordinateSystemOffset(getDreamMugenStageHandlerCameraCoordinateP()) + getHandledPhysicsPosition(tPlayer->mPhysicsElement).xy();
+	AfterImageHistoryBufferEntry& e = *acquireHistoryBufferSlot(tPlayer, animation, p.xyz(PLAYER_Z));
+	setMugenAnimationDrawScale(e.mAnimationElement, Vector2D(getPlayerScaleX(tPlayer), getPlayerScaleY(tPlayer)) * tPlayer->mTempScale * getPlayerToCameraScale(tPlayer));
 
 	setMugenAnimationFaceDirection(e.mAnimationElement, getPlayerIsFacingRight(tPlayer));
-	if (tPlayer->mIsAngleActive) {
-		setMugenAnimationDrawAngle(e.mAnimationElement, degreesToRadians(tPlayer->mAngle));
-	}
+	setMugenAnimationDrawAngle(e.mAnimationElement, tPlayer->mIsAngleActive ? degreesToRadians(tPlayer->mAngle) : 0);
 	if (afterImage.mBlendType == BLEND_TYPE_NORMAL) {
 		setMugenAnimationBlendType(e.mAnimationElement, getMugenAnimationBlendType(tPlayer->mAnimationElement));
 	}
@@ -43,21 +82,27 @@ static void addHistoryBufferElement(DreamPlayer* tPlayer) {
 	setMugenAnimationVisibility(e.mAnimationElement, 0);
 	setMugenAnimationColor(e.mAnimationElement, afterImage.mStartColor.x, afterImage.mStartColor.y, afterImage.mStartColor.z);
 	setMugenAnimationColorInverted(e.mAnimationElement, afterImage.mIsColorInverted);
-	afterImage.mHistoryBuffer.push_front(e);
 }
 
-static void unloadHistoryBufferElement(const AfterImageHistoryBufferEntry& tEntry) {
-	removeMugenAnimation(tEntry.mAnimationElement);
-	destroyMugenAnimation(tEntry.mAnimation);
+static void removeOldestHistoryBufferElement(DreamPlayerAfterImage& tAfterImage) {
+	AfterImageHistoryBufferEntry& e = getHistoryBufferEntry(tAfterImage, tAfterImage.mHistoryBufferAmount - 1);
+	setMugenAnimationVisibility(e.mAnimationElement, 0);
+	tAfterImage.mHistoryBufferAmount--;
 }
 
 void removePlayerAfterImage(DreamPlayer* p)
 {
 	DreamPlayerAfterImage& afterImage = p->mAfterImage;
-	while (!p->mAfterImage.mHistoryBuffer.empty()) {
-		unloadHistoryBufferElement(afterImage.mHistoryBuffer.back());
-		afterImage.mHistoryBuffer.pop_back();
+	for (auto& e : afterImage.mHistoryBuffer) {
+		removeMugenAnimation(e.mAnimationElement);
 	}
+	for (auto& spriteAnimation : afterImage.mSpriteAnimations) {
+		destroyMugenAnimation(spriteAnimation.second);
+	}
+	afterImage.mHistoryBuffer.clear();
+	afterImage.mHistoryBufferStart = 0;
+	afterImage.mHistoryBufferAmount = 0;
+	afterImage.mSpriteAnimations.clear();
 }
 
 void addAfterImage(DreamPlayer* tPlayer, int tHistoryBufferLength, int tDuration, int tTimeGap, int tFrameGap, const Vector3D& tStartColor, const Vector3D& tColorAdd, const Vector3D& tColorMultiply, int tIsColorInverted, BlendType tBlendType)
@@ -95,14 +140,13 @@ static void updateAddingSingleAfterImage(DreamPlayer* tPlayer) {
 
 static void updateRemovingAfterImage(DreamPlayer* tPlayer) {
 	DreamPlayerAfterImage& afterImage = tPlayer->mAfterImage;
-	if (afterImage.mHistoryBuffer.empty()) return;
+	if (!afterImage.mHistoryBufferAmount) return;
 
 	const auto tick = getDreamGameTime();
 	if (tick % afterImage.mTimeGap) return;
 
-	if (!afterImage.mIsActive || int(afterImage.mHistoryBuffer.size()) > afterImage.mHistoryBufferLength) {
-		unloadHistoryBufferElement(afterImage.mHistoryBuffer.back());
-		afterImage.mHistoryBuffer.pop_back();
+	if (!afterImage.mIsActive || afterImage.mHistoryBufferAmount > afterImage.mHistoryBufferLength) {
+		removeOldestHistoryBufferElement(afterImage);
 	}
 }
 
@@ -128,13 +172,15 @@ static void updateSingleHistoryBuffer(HistoryBufferUpdateCaller* tCaller, AfterI
 
 static void updateActiveHistoryBuffer(DreamPlayer* tPlayer) {
 	DreamPlayerAfterImage& afterImage = tPlayer->mAfterImage;
-	if (afterImage.mHistoryBuffer.empty()) return;
+	if (!afterImage.mHistoryBufferAmount) return;
 
 	HistoryBufferUpdateCaller caller;
 	caller.mPlayer = tPlayer;
 	caller.mIndex = 0;
 	caller.mColor = afterImage.mStartColor;
-	stl_list_map(afterImage.mHistoryBuffer, updateSingleHistoryBuffer, &caller);
+	for (int i = 0; i < afterImage.mHistoryBufferAmount; i++) {
+		updateSingleHistoryBuffer(&caller, getHistoryBufferEntry(afterImage, i));
+	}
 }
 
 static void updateAfterImageOver(DreamPlayer* tPlayer) {
@@ -8,14 +8,17 @@ using namespace prism;
 struct DreamPlayer;
 
 struct AfterImageHistoryBufferEntry {
-	MugenAnimation* mAnimation;
+	MugenAnimation* mAnimation; // owned by mSpriteAnimations
 	MugenAnimationHandlerElement* mAnimationElement;
 	int mWasVisible;
 };
 
 struct DreamPlayerAfterImage{
 	int mIsActive;
-	std::list<AfterImageHistoryBufferEntry> mHistoryBuffer;
+	std::vector<AfterImageHistoryBufferEntry> mHistoryBuffer; // ring of reused slots, newest entry at mHistoryBufferStart
+	int mHistoryBufferStart;
+	int mHistoryBufferAmount;
+	std::map<std::pair<int, int>, MugenAnimation*> mSpriteAnimations; // one-frame animation per captured sprite
 
 	int mHistoryBufferLength;
 	int mNow;
@@ -15,6 +15,7 @@ using namespace std;
 
 typedef struct {
 	DreamPlayer* mPlayer;
+	DreamPlayerReference mPlayerReference;
 
 	double mDifficultyFactor;
 	int mRandomInputNow;
@@ -159,6 +160,7 @@ static void updateAICommands(PlayerAI* e) {
 static void updateSingleAI(void* /*tCaller*/, PlayerAI& tData) {
 	if (getDreamRoundStateNumber() != 2) return;
 	PlayerAI* e = &tData;
+	if (!getReferencedPlayer(e->mPlayerReference)) return;
 	if (!getPlayerAILevel(e->mPlayer)) return;
 
 	updateAIMovement(e);
@@ -181,6 +183,7 @@ void setDreamAIActive(DreamPlayer * p)
 {
 	PlayerAI e;
 	e.mPlayer = p;
+	e.mPlayerReference = getPlayerReference(p);
 	e.mRandomInputNow = 0;
 	e.mRandomInputDuration = 20;
 	e.mIsMoving = 0;
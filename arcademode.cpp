@@ -19,6 +19,7 @@
 #include "fightresultdisplay.h"
 #include "config.h"
 #include "victoryquotescreen.h"
+#include "matchprefetch.h"
 
 using namespace std;
 
@@ -53,6 +54,7 @@ static void gameOverFinishedCB() {
 }
 
 static void fightLoseCB() {
+	cancelMatchPrefetch();
 	if (gArcadeModeData.mHasGameOver) {
 		setStoryDefinitionFileAndPrepareScreen(gArcadeModeData.mGameOverPath);
 		setStoryScreenFinishedCB(gameOverFinishedCB);
@@ -63,9 +65,18 @@ static void fightLoseCB() {
 	}
 }
 
+static void armNextArcadeEnemyPrefetch() {
+	const auto nextEnemy = gArcadeModeData.mCurrentEnemy + 1;
+	if (nextEnemy >= gArcadeModeData.mEnemyAmount) return;
+
+	ArcadeCharacter* e = &gArcadeModeData.mEnemies[nextEnemy];
+	armMatchPrefetch(e->mDefinitionPath, strcmp("random", e->mStagePath) ? e->mStagePath : NULL);
+}
+
 static void versusScreenFinishedCB() {
 
 	int isFinalFight = gArcadeModeData.mCurrentEnemy == gArcadeModeData.mEnemyAmount - 1;
+	armNextArcadeEnemyPrefetch();
 	setGameModeArcade();
 	setPlayerArtificial(1, calculateAIRampDifficulty(gArcadeModeData.mCurrentEnemy, getArcadeAIRampStart(), getArcadeAIRampEnd()));
 	setFightResultActive(isFinalFight && !gArcadeModeData.mHasEnding);
@@ -395,6 +406,7 @@ static void loadArcadeModeHeaderFromScript() {
 
 void startArcadeMode()
 {
+	cancelMatchPrefetch();
 	loadArcadeModeHeaderFromScript();
 
 	setCharacterSelectScreenModeName("Arcade");
@@ -0,0 +1,157 @@
+#include "characterpackage.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <map>
+#include <string>
+
+#include <prism/file.h>
+#include <prism/log.h>
+#include <prism/debug.h>
+
+using namespace prism;
+
+typedef struct {
+	uint32_t mOffset;
+	uint32_t mSize;
+} CharacterPackageEntry;
+
+static struct {
+	int mIsActive;
+	Buffer mBuffer;
+	std::string mFolder;
+	std::map<std::string, CharacterPackageEntry> mEntries; // keyed by lowercase path relative to the package folder
+} gCharacterPackageData;
+
+static std::string toCharacterPackageKey(std::string tName) {
+	for (auto& c : tName) {
+		c = (c == '\\') ? '/' : char(tolower(c));
+	}
+	return tName;
+}
+
+static std::string getCharacterPackageKey(const char* tPath) {
+	const auto& folder = gCharacterPackageData.mFolder;
+	if (strncmp(tPath, folder.c_str(), folder.size())) return "";
+	return toCharacterPackageKey(tPath + folder.size());
+}
+
+static const CharacterPackageEntry* getCharacterPackageEntry(const char* tPath) {
+	if (!gCharacterPackageData.mIsActive) return NULL;
+
+	const auto it = gCharacterPackageData.mEntries.find(getCharacterPackageKey(tPath));
+	if (it == gCharacterPackageData.mEntries.end()) return NULL;
+	return &it->second;
+}
+
+static int hasCharacterPackageBytesLeft(BufferPointer p, uint64_t tAmount) {
+	const auto& b = gCharacterPackageData.mBuffer;
+	return uint64_t(p - getBufferPointer(b)) + tAmount <= uint64_t(b.mLength);
+}
+
+static int isCharacterPackageEntryStale(const std::string& tName, uint32_t tSourceSize, uint32_t tSourceModificationTime) {
+	char fullPath[1024];
+	getFullPath(fullPath, (gCharacterPackageData.mFolder + tName).c_str());
+	struct stat fileStatus;
+	if (stat(fullPath, &fileStatus)) return 0; // packed-only characters ship without loose files
+
+	if (uint32_t(fileStatus.st_size) != tSourceSize) return 1;
+#ifndef DREAMCAST
+	if (uint32_t(fileStatus.st_mtime) != tSourceModificationTime) return 1; // disc images do not keep the packer's timestamps
+#endif
+	return 0;
+}
+
+static int readCharacterPackageTableOfContents(const char* tPackagePath) {
+	auto p = getBufferPointer(gCharacterPackageData.mBuffer);
+	const auto size = gCharacterPackageData.mBuffer.mLength;
+	const auto magicSize = strlen(CHARACTER_PACKAGE_MAGIC);
+	if (size < magicSize + sizeof(uint32_t) || strncmp(p, CHARACTER_PACKAGE_MAGIC, magicSize)) {
+		logWarningFormat("Character package %s has invalid header. Ignoring package.", tPackagePath);
+		return 0;
+	}
+	p += magicSize;
+
+	uint32_t entryAmount;
+	readFromBufferPointer(&entryAmount, &p, sizeof(uint32_t));
+	for (uint32_t i = 0; i < entryAmount; i++) {
+		uint32_t nameLength;
+		if (!hasCharacterPackageBytesLeft(p, sizeof(uint32_t))) {
+			logWarningFormat("Character package %s has truncated table of contents. Ignoring package.", tPackagePath);
+			return 0;
+		}
+		readFromBufferPointer(&nameLength, &p, sizeof(uint32_t));
+		if (!hasCharacterPackageBytesLeft(p, uint64_t(nameLength) + 4 * sizeof(uint32_t))) {
+			logWarningFormat("Character package %s has truncated table of contents. Ignoring package.", tPackagePath);
+			return 0;
+		}
+		std::string name(p, nameLength);
+		p += nameLength;
+
+		CharacterPackageEntry e;
+		uint32_t sourceSize, sourceModificationTime;
+		readFromBufferPointer(&e.mOffset, &p, sizeof(uint32_t));
+		readFromBufferPointer(&e.mSize, &p, sizeof(uint32_t));
+		readFromBufferPointer(&sourceSize, &p, sizeof(uint32_t));
+		readFromBufferPointer(&sourceModificationTime, &p, sizeof(uint32_t));
+		if (uint64_t(e.mOffset) + e.mSize > size) {
+			logWarningFormat("Character package %s entry %s out of bounds. Ignoring package.", tPackagePath, name.c_str());
+			return 0;
+		}
+		if (isInDevelopMode() && isCharacterPackageEntryStale(name, sourceSize, sourceModificationTime)) { // only where loose files get edited, release builds skip the stat per file
+			logWarningFormat("Character package %s is older than %s. Ignoring package.", tPackagePath, name.c_str());
+			return 0;
+		}
+		gCharacterPackageData.mEntries[toCharacterPackageKey(name)] = e;
+	}
+
+	return 1;
+}
+
+void loadCharacterPackage(const char* tDefinitionPath)
+{
+	unloadCharacterPackage();
+
+	char packagePath[1024];
+	sprintf(packagePath, "%s.pak", tDefinitionPath);
+	if (!isFile(packagePath)) return;
+
+	char folder[1024];
+	getPathToFile(folder, tDefinitionPath);
+	gCharacterPackageData.mFolder = folder;
+	gCharacterPackageData.mBuffer = fileToBuffer(packagePath);
+	gCharacterPackageData.mIsActive = 1;
+	if (!readCharacterPackageTableOfContents(packagePath)) {
+		unloadCharacterPackage();
+	}
+}
+
+void unloadCharacterPackage()
+{
+	if (!gCharacterPackageData.mIsActive) return;
+
+	freeBuffer(gCharacterPackageData.mBuffer);
+	gCharacterPackageData.mEntries.clear();
+	gCharacterPackageData.mIsActive = 0;
+}
+
+int isCharacterFile(const char* tPath)
+{
+	return getCharacterPackageEntry(tPath) || isFile(tPath);
+}
+
+void loadCharacterMugenDefScript(MugenDefScript* oScript, const char* tPath)
+{
+	const auto e = getCharacterPackageEntry(tPath);
+	if (!e) {
+		loadMugenDefScript(oScript, tPath);
+		return;
+	}
+
+	Buffer b = makeBufferEmptyOwned();
+	appendBufferBuffer(&b, makeBuffer(getBufferPointer(gCharacterPackageData.mBuffer) + e->mOffset, e->mSize));
+	loadMugenDefScriptFromBufferAndFreeBuffer(oScript, b);
+}
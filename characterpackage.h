@@ -0,0 +1,12 @@
+#pragma once
+
+#include <prism/mugendefreader.h>
+
+#define CHARACTER_PACKAGE_MAGIC "DOLPAK02"
+#define CHARACTER_PACKAGE_ALIGNMENT 2048
+
+void loadCharacterPackage(const char* tDefinitionPath);
+void unloadCharacterPackage();
+
+int isCharacterFile(const char* tPath);
+void loadCharacterMugenDefScript(MugenDefScript* oScript, const char* tPath);
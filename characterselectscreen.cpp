@@ -1,6 +1,7 @@
 #include "characterselectscreen.h"
 
 #include <assert.h>
+#include <limits.h>
 #include <algorithm>
 #include <string>
 
@@ -14,6 +15,7 @@
 #include <prism/clipboardhandler.h>
 #include <prism/log.h>
 #include <prism/math.h>
+#include <prism/system.h>
 
 #include "mugensound.h"
 #include "scriptbackground.h"
@@ -25,9 +27,17 @@
 #include "storymode.h"
 #include "config.h"
 #include "mugenassignmentevaluator.h"
+#include "rosterindex.h"
 
 #define SELECTOR_Z 49
 
+#ifdef DREAMCAST
+#define SELECT_PORTRAIT_CACHE_SIZE 48
+#else
+#define SELECT_PORTRAIT_CACHE_SIZE 256
+#endif
+#define SELECT_PORTRAIT_LOAD_BUDGET_TICKS 8
+
 using namespace std;
 
 typedef struct {
@@ -90,6 +100,8 @@ typedef struct {
 	MugenAnimation* mSmallPortraitAnimation;
 	Position2D mSmallPortraitOffset;
 	Vector2D mSmallPortraitScale;
+	int mIsPortraitPlaceholderAnimationOwned;
+	MugenAnimation* mPortraitPlaceholderAnimation;
 
 	Position2D mTitleOffset;
 	Vector3DI mTitleFont;
@@ -118,6 +130,8 @@ typedef struct {
 	MugenAnimationHandlerElement* mBackgroundAnimationElement;
 
 	MugenSpriteFile mSprites;
+	int mIsPortraitLoaded;
+	const RosterIndexEntry* mRosterEntry; // NULL unless the portrait is streamed in by updatePortraitLoading
 	MugenAnimationHandlerElement* mPortraitAnimationElement;
 	char mStageName[1024];
 	char* mDisplayCharacterName;
@@ -156,6 +170,7 @@ typedef struct {
 
 	int mHasBeenLoadedBefore;
 	Vector2DI mSelectedCharacter;
+	SelectCharacter* mShownCharacter;
 	RandomSelector mRandom;
 } Selector;
 
@@ -220,6 +235,7 @@ static struct {
 
 	int mCharacterAmount;
 	std::list<std::list<SelectCharacter>> mSelectCharacters;
+	int mLoadedPortraitAmount;
 	Vector mSelectStages; // vector of SelectStage
 	std::vector<SelectCharacter*> mRealSelectCharacters;
 	int mSelectorAmount;
@@ -467,6 +483,7 @@ static void loadMenuHeader() {
 
 	gCharacterSelectScreenData.mHeader.mSmallPortraitOffset = getMugenDefVector2DOrDefault(&gCharacterSelectScreenData.mScript, "select info", "portrait.offset", Vector2D(0, 0));
 	gCharacterSelectScreenData.mHeader.mSmallPortraitScale = getMugenDefVector2DOrDefault(&gCharacterSelectScreenData.mScript, "select info", "portrait.scale", Vector2D(1, 1));
+	gCharacterSelectScreenData.mHeader.mPortraitPlaceholderAnimation = getMugenDefMenuAnimationOrSprite(&gCharacterSelectScreenData.mScript, "select info", "portrait.placeholder", gCharacterSelectScreenData.mHeader.mIsPortraitPlaceholderAnimationOwned);
 
 	gCharacterSelectScreenData.mHeader.mTitleOffset = getMugenDefVector2DOrDefault(&gCharacterSelectScreenData.mScript, "select info", "title.offset", Vector2D(0, 0));
 	gCharacterSelectScreenData.mHeader.mTitleFont = getMugenDefVectorIOrDefault(&gCharacterSelectScreenData.mScript, "select info", "title.font", Vector3DI(-1, 0, 0));
@@ -483,64 +500,41 @@ typedef struct {
 
 } MenuCharacterLoadCaller;
 
-static void loadMenuCharacterCredits(SelectCharacter& e, MugenDefScript* tScript) {
+static void loadMenuCharacterCredits(SelectCharacter& e, const RosterIndexEntry* tEntry) {
 	if (gCharacterSelectScreenData.mSelectScreenType != CHARACTER_SELECT_SCREEN_TYPE_CREDITS) return;
 
-	e.mCredits.mName = getAllocatedMugenDefStringOrDefault(tScript, "info", "name", e.mDisplayCharacterName);
-	e.mCredits.mAuthorName = getAllocatedMugenDefStringOrDefault(tScript, "info", "author", "N/A");
-	e.mCredits.mVersionDate = getAllocatedMugenDefStringOrDefault(tScript, "info", "versiondate", "N/A");
+	e.mCredits.mName = copyToAllocatedString((char*)tEntry->mName.c_str());
+	e.mCredits.mAuthorName = copyToAllocatedString((char*)tEntry->mAuthorName.c_str());
+	e.mCredits.mVersionDate = copyToAllocatedString((char*)tEntry->mVersionDate.c_str());
 }
 
 static int loadMenuCharacterSpritesAndNameAndReturnWhetherExists(SelectCharacter& e, const char* tCharacterName, const char* tOptionalDisplayName) {
 	
-	char file[200];
-	char path[1024];
 	char scriptPath[1024];
-	char scriptPathPreloaded[1024];
-	char name[100];
-	char palettePath[1024];
 
 	string sanitizedCharacterName = std::string(tCharacterName);
 	std::replace(sanitizedCharacterName.begin(), sanitizedCharacterName.end(), '\\', '/');
 
 	getCharacterSelectNamePath(sanitizedCharacterName.c_str(), scriptPath);
-	if (!isFile(scriptPath)) {
-		return 0;
-	}
-
 	e.mDisplayCharacterName = nullptr;
 
 	if(!gCharacterSelectScreenData.mHeader.mIsSkippingCharScriptLoading)
 	{
-		MugenDefScript script;
-		loadMugenDefScript(&script, scriptPath);
+		const auto entry = getRosterIndexEntry(scriptPath);
+		if (!entry) {
+			return 0;
+		}
 
 		if (gCharacterSelectScreenData.mHeader.mIsShowingPortraits) {
-			getPathToFile(path, scriptPath);
-
-			int preferredPalette = 0;
-			sprintf(name, "pal%d", preferredPalette + 1);
-			getMugenDefStringOrDefault(file, &script, "files", name, "");
-			int hasPalettePath = strcmp("", file);
-			sprintf(palettePath, "%s%s", path, file);
-
-			getMugenDefStringOrDefault(file, &script, "files", "sprite", "");
-			assert(strcmp("", file));
-			sprintf(scriptPath, "%s%s", path, file);
-			sprintf(scriptPathPreloaded, "%s.portraits.preloaded", scriptPath);
-			if (isFile(scriptPathPreloaded)) {
-				e.mSprites = loadMugenSpriteFilePortraits(scriptPathPreloaded, hasPalettePath, palettePath);
-			}
-			else {
-				e.mSprites = loadMugenSpriteFilePortraits(scriptPath, hasPalettePath, palettePath);
-			}
+			e.mRosterEntry = entry;
 		}
 
-		e.mDisplayCharacterName = getAllocatedMugenDefStringVariable(&script, "info", "displayname");
+		e.mDisplayCharacterName = copyToAllocatedString((char*)entry->mDisplayName.c_str());
 
-		loadMenuCharacterCredits(e, &script);
-		
-		unloadMugenDefScript(&script);
+		loadMenuCharacterCredits(e, entry);
+	}
+	else if (!isFile(scriptPath)) {
+		return 0;
 	}
 
 	strcpy(e.mCharacterName, sanitizedCharacterName.c_str());
@@ -568,7 +562,12 @@ static Position2D getCellScreenPosition(const Vector2DI& tCellPosition) {
 static void showMenuSelectableAnimations(MenuCharacterLoadCaller* /*tCaller*/, SelectCharacter& e) {
 	auto pos = getCellScreenPosition(e.mCellPosition).xyz(40.0);
 	if (gCharacterSelectScreenData.mHeader.mIsShowingPortraits) {
-		e.mPortraitAnimationElement = addMugenAnimation(gCharacterSelectScreenData.mHeader.mSmallPortraitAnimation, &e.mSprites, pos + gCharacterSelectScreenData.mHeader.mSmallPortraitOffset);
+		if (e.mIsPortraitLoaded) {
+			e.mPortraitAnimationElement = addMugenAnimation(gCharacterSelectScreenData.mHeader.mSmallPortraitAnimation, &e.mSprites, pos + gCharacterSelectScreenData.mHeader.mSmallPortraitOffset);
+		}
+		else {
+			e.mPortraitAnimationElement = addMugenAnimation(gCharacterSelectScreenData.mHeader.mPortraitPlaceholderAnimation, &gCharacterSelectScreenData.mSprites, pos + gCharacterSelectScreenData.mHeader.mSmallPortraitOffset);
+		}
 		setMugenAnimationDrawScale(e.mPortraitAnimationElement, gCharacterSelectScreenData.mHeader.mSmallPortraitScale);
 	}
 	if (!gCharacterSelectScreenData.mHeader.mIsShowingEmptyBoxes) {
@@ -663,7 +662,9 @@ static void loadMenuCharacters() {
 	MenuCharacterLoadCaller caller;
 	caller.i = 0;
 
+	loadRosterIndex();
 	list_map(&e->mOrderedElementList, loadSingleMenuCharacter, &caller);
+	saveRosterIndex();
 	gCharacterSelectScreenData.mCharacterAmount = caller.i;
 }
 
@@ -685,6 +686,7 @@ static int loadSingleStoryFileAndReturnWhetherItExists(SelectCharacter& e, char*
 	assert(strcmp("", file));
 	sprintf(scriptPath, "%s%s", path, file);
 	e.mSprites = loadMugenSpriteFileWithoutPalette(scriptPath);
+	e.mIsPortraitLoaded = 1;
 
 	strcpy(e.mCharacterName, tPath);
 	e.mDisplayCharacterName = getAllocatedMugenDefStringVariable(&script, "info", "name");
@@ -752,6 +754,8 @@ static void loadSingleMenuCell(const Vector2DI& tCellPosition) {
 	SelectCharacter e;
 	e.mType = SELECT_CHARACTER_TYPE_EMPTY;
 	e.mCellPosition = tCellPosition;
+	e.mIsPortraitLoaded = 0;
+	e.mRosterEntry = NULL;
 
 	if (gCharacterSelectScreenData.mHeader.mIsShowingEmptyBoxes) {
 		const auto pos = getCellScreenPosition(e.mCellPosition).xyz(30.0);
@@ -765,6 +769,7 @@ static void loadSingleMenuCell(const Vector2DI& tCellPosition) {
 static void loadMenuCells() {
 	gCharacterSelectScreenData.mSelectCharacters.clear();
 	gCharacterSelectScreenData.mRealSelectCharacters.clear();
+	gCharacterSelectScreenData.mLoadedPortraitAmount = 0;
 	
 	int y, x;
 	for (y = 0; y < gCharacterSelectScreenData.mHeader.mRows; y++) {
@@ -865,6 +870,7 @@ static void unloadSingleSelector(int i) {
 	removeMugenText(gCharacterSelectScreenData.mSelectors[i].mNameTextID);
 
 	gCharacterSelectScreenData.mSelectors[i].mIsActive = 0;
+	gCharacterSelectScreenData.mSelectors[i].mShownCharacter = NULL;
 }
 
 static void loadSelectors() {
@@ -872,6 +878,7 @@ static void loadSelectors() {
 	int i;
 	for (i = 0; i < 2; i++) {
 		gCharacterSelectScreenData.mSelectors[i].mIsActive = 0;
+		gCharacterSelectScreenData.mSelectors[i].mShownCharacter = NULL;
 	}
 
 	gCharacterSelectScreenData.mSelectorAmount = gCharacterSelectScreenData.mSelectScreenType == CHARACTER_SELECT_SCREEN_TYPE_TWO_PLAYER_MODE ? 2 : 1;
@@ -1043,7 +1050,7 @@ static void unloadMenuCharacterCredits(SelectCharacter& e) {
 
 static void unloadSingleSelectCharacter(SelectCharacter& e) {
 	if (e.mType == SELECT_CHARACTER_TYPE_CHARACTER) {
-		if (gCharacterSelectScreenData.mHeader.mIsShowingPortraits) {
+		if (e.mIsPortraitLoaded) {
 			unloadMugenSpriteFile(&e.mSprites);
 		}
 		freeMemory(e.mDisplayCharacterName);
@@ -1082,6 +1089,9 @@ static void unloadCharacterSelectScreen() {
 	if (gCharacterSelectScreenData.mHeader.mIsRandomSelectionAnimationOwned) {
 		destroyMugenAnimation(gCharacterSelectScreenData.mHeader.mRandomSelectionAnimation);
 	}
+	if (gCharacterSelectScreenData.mHeader.mIsPortraitPlaceholderAnimationOwned) {
+		destroyMugenAnimation(gCharacterSelectScreenData.mHeader.mPortraitPlaceholderAnimation);
+	}
 
 	int i;
 	for (i = 0; i < 2; i++) {
@@ -1164,11 +1174,82 @@ static void updateCharacterSelectionCredits(SelectCharacter* character) {
 	}
 }
 
+static void loadSelectCharacterPortrait(SelectCharacter& e) {
+	if (e.mIsPortraitLoaded || !e.mRosterEntry) return;
+
+	e.mSprites = loadMugenSpriteFilePortraits(e.mRosterEntry->mSpritePath.c_str(), e.mRosterEntry->mHasPalettePath, e.mRosterEntry->mPalettePath.c_str());
+	e.mIsPortraitLoaded = 1;
+	gCharacterSelectScreenData.mLoadedPortraitAmount++;
+	setMugenAnimationSprites(e.mPortraitAnimationElement, &e.mSprites);
+	changeMugenAnimation(e.mPortraitAnimationElement, gCharacterSelectScreenData.mHeader.mSmallPortraitAnimation);
+}
+
+static void unloadSelectCharacterPortrait(SelectCharacter& e) {
+	if (!e.mIsPortraitLoaded || !e.mRosterEntry) return;
+
+	setMugenAnimationSprites(e.mPortraitAnimationElement, &gCharacterSelectScreenData.mSprites);
+	changeMugenAnimation(e.mPortraitAnimationElement, gCharacterSelectScreenData.mHeader.mPortraitPlaceholderAnimation);
+	unloadMugenSpriteFile(&e.mSprites);
+	e.mIsPortraitLoaded = 0;
+	gCharacterSelectScreenData.mLoadedPortraitAmount--;
+}
+
+static int isSelectCharacterShownBySelector(SelectCharacter* e) {
+	for (int i = 0; i < gCharacterSelectScreenData.mSelectorAmount; i++) {
+		if (gCharacterSelectScreenData.mSelectors[i].mShownCharacter == e) return 1;
+	}
+	return 0;
+}
+
+static int getSelectCharacterCursorDistance(const SelectCharacter& e) {
+	int ret = INT_MAX;
+	for (int i = 0; i < gCharacterSelectScreenData.mSelectorAmount; i++) {
+		if (!gCharacterSelectScreenData.mSelectors[i].mIsActive) continue;
+		const auto dx = e.mCellPosition.x - gCharacterSelectScreenData.mSelectors[i].mSelectedCharacter.x;
+		const auto dy = e.mCellPosition.y - gCharacterSelectScreenData.mSelectors[i].mSelectedCharacter.y;
+		ret = std::min(ret, dx * dx + dy * dy);
+	}
+	return ret == INT_MAX ? 0 : ret;
+}
+
+static void updatePortraitLoading() {
+	if (!gCharacterSelectScreenData.mHeader.mIsShowingPortraits) return;
+
+	const auto startTicks = getSystemTicks();
+	do {
+		SelectCharacter* nearestUnloaded = NULL;
+		SelectCharacter* farthestLoaded = NULL;
+		int nearestDistance = INT_MAX;
+		int farthestDistance = -1;
+		for (auto e : gCharacterSelectScreenData.mRealSelectCharacters) {
+			if (!e->mRosterEntry) continue;
+			const auto distance = getSelectCharacterCursorDistance(*e);
+			if (!e->mIsPortraitLoaded && distance < nearestDistance) {
+				nearestUnloaded = e;
+				nearestDistance = distance;
+			}
+			else if (e->mIsPortraitLoaded && distance > farthestDistance && !isSelectCharacterShownBySelector(e)) {
+				farthestLoaded = e;
+				farthestDistance = distance;
+			}
+		}
+		if (!nearestUnloaded) return;
+
+		if (gCharacterSelectScreenData.mLoadedPortraitAmount >= SELECT_PORTRAIT_CACHE_SIZE) {
+			if (!farthestLoaded || farthestDistance <= nearestDistance) return;
+			unloadSelectCharacterPortrait(*farthestLoaded);
+		}
+		loadSelectCharacterPortrait(*nearestUnloaded);
+	} while (getSystemTicks() - startTicks < SELECT_PORTRAIT_LOAD_BUDGET_TICKS);
+}
+
 static void showSelectCharacterForSelector(int i, SelectCharacter* tCharacter) {
 	PlayerHeader* player = &gCharacterSelectScreenData.mHeader.mPlayers[i];
 
+	gCharacterSelectScreenData.mSelectors[i].mShownCharacter = tCharacter;
 	if (tCharacter->mType == SELECT_CHARACTER_TYPE_CHARACTER) {
 		if (gCharacterSelectScreenData.mHeader.mIsShowingPortraits) {
+			loadSelectCharacterPortrait(*tCharacter);
 			setMugenAnimationBaseDrawScale(gCharacterSelectScreenData.mSelectors[i].mBigPortraitAnimationElement, 1);
 			setMugenAnimationSprites(gCharacterSelectScreenData.mSelectors[i].mBigPortraitAnimationElement, &tCharacter->mSprites);
 			changeMugenAnimation(gCharacterSelectScreenData.mSelectors[i].mBigPortraitAnimationElement, player->mBigPortraitAnimation);
@@ -1610,6 +1691,7 @@ static void updateStageSelect() {
 }
 
 static void updateCharacterSelectScreen() {
+	updatePortraitLoading();
 	updateSelections();
 	updateSelectionInputs();
 	updateStageSelect();
@@ -1842,6 +1924,28 @@ int setCharacterRandomAndReturnIfSuccessful(MugenDefScript* tScript, int i)
 	return 1;
 }
 
+int getCharacterRandomPathAndReturnIfSuccessful(MugenDefScript* tScript, char* oPath, int tRandomValue)
+{
+	MugenDefScriptGroup* e = &tScript->mGroups["characters"];
+
+	RandomCharacterCaller caller;
+	caller.mElements = new_vector();
+
+	list_map(&e->mOrderedElementList, loadSingleRandomCharacter, &caller);
+
+	if (!vector_size(&caller.mElements)) {
+		delete_vector(&caller.mElements);
+		return 0;
+	}
+
+	int index = tRandomValue % vector_size(&caller.mElements);
+	PossibleRandomCharacterElement* newChar = (PossibleRandomCharacterElement*)vector_get(&caller.mElements, index);
+	strcpy(oPath, newChar->mPath);
+
+	delete_vector(&caller.mElements);
+	return 1;
+}
+
 typedef struct {
 	char mPath[1024];
 
@@ -25,4 +25,5 @@ void parseOptionalCharacterSelectParameters(const MugenStringVector& tVector, in
 void getCharacterSelectNamePath(const char* tName, char* oDst);
 
 int setCharacterRandomAndReturnIfSuccessful(MugenDefScript* tScript, int i);
+int getCharacterRandomPathAndReturnIfSuccessful(MugenDefScript* tScript, char* oPath, int tRandomValue);
 void setStageRandom(MugenDefScript* tScript);
\ No newline at end of file
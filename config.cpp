@@ -47,6 +47,7 @@ typedef struct {
 	int mIsUsingStaticAssignments;
 	double mGameSpeedFactor;
 	int mIsDrawingShadows;
+	int mExplodMax;
 } ConfigConfigData;
 
 typedef struct {
@@ -128,6 +129,7 @@ static void loadConfigConfig(MugenDefScript* tScript) {
 	const auto gameSpeed = getMugenDefIntegerOrDefault(tScript, "config", "gamespeed", 60);
 	gConfigData.mConfig.mGameSpeedFactor = gameSpeed / 60.0;
 	gConfigData.mConfig.mIsDrawingShadows = getMugenDefIntegerOrDefault(tScript, "config", "drawshadows", 1);
+	gConfigData.mConfig.mExplodMax = std::max(1, getMugenDefIntegerOrDefault(tScript, "config", "explodmax", 512));
 
 	setWrapperTimeDilatation(gConfigData.mConfig.mGameSpeedFactor);
 }
@@ -432,6 +434,11 @@ int isDrawingShadowsConfig()
 	return gConfigData.mConfig.mIsDrawingShadows;
 }
 
+int getConfigExplodMax()
+{
+	return gConfigData.mConfig.mExplodMax;
+}
+
 void setDefaultOptionVariables() {
 	gConfigData.mOptions.mActive = gConfigData.mOptions.mDefault;
 
@@ -31,6 +31,7 @@ const std::string& getMugenConfigStartStage();
 int isUsingStaticAssignments();
 double getConfigGameSpeedTimeFactor();
 int isDrawingShadowsConfig();
+int getConfigExplodMax();
 
 void setDefaultOptionVariables();
 int getDifficulty();
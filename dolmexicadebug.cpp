@@ -20,6 +20,7 @@
 #include "randomwatchmode.h"
 #include "config.h"
 #include "mugenstatehandler.h"
+#include "fightreplay.h"
 
 typedef struct {
 	int mPreviousValue;
@@ -596,6 +597,22 @@ static std::string randomSeedCB(void* /*tCaller*/, const std::string& tCommand)
 	return "";
 }
 
+static std::string recordReplayCB(void* /*tCaller*/, const std::string& tCommand) {
+	const auto words = splitCommandString(tCommand);
+	if (words.size() < 2) return "Too few arguments";
+	armFightReplayRecording(words[1].c_str());
+	return "";
+}
+
+static std::string replayCB(void* /*tCaller*/, const std::string& tCommand) {
+	const auto words = splitCommandString(tCommand);
+	if (words.size() < 2) return "Too few arguments";
+	setGameModeVersus(); // before loading, so the recorded palettes are not reset
+	if (!loadFightReplay(words[1].c_str())) return "Unable to load replay";
+	startFightScreen(mockFightFinishedCB);
+	return "";
+}
+
 static std::string airJumpCB(void* /*tCaller*/, const std::string& tCommand) {
 	const auto words = splitCommandString(tCommand);
 	if (words.size() < 2) return "Too few arguments";
@@ -637,6 +654,8 @@ void initDolmexicaDebug()
 	addPrismDebugConsoleCommand("fullstagetest", fullStageTestCB);
 	addPrismDebugConsoleCommand("randomseed", randomSeedCB);
 	addPrismDebugConsoleCommand("airjump", airJumpCB);
+	addPrismDebugConsoleCommand("recordreplay", recordReplayCB);
+	addPrismDebugConsoleCommand("replay", replayCB);
 }
 
 static void loadDolmexicaDebugHandler(void* tData) {
@@ -1,42 +1,323 @@
 #include "fightnetplay.h"
 
 #include <assert.h>
+#include <string.h>
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <sstream>
 
 #include <prism/netplay.h>
+#include <prism/log.h>
+#include <prism/math.h>
 
 #include "gamelogic.h"
 #include "playerdefinition.h"
 #include "mugencommandhandler.h"
 #include "netplaylogic.h"
 
+#define FIGHT_SYNC_CHECK_HISTORY_SIZE 60
+#define FIGHT_NETPLAY_LOOPBACK_SYNC_CHECK_INTERVAL 10
+
+struct FightSyncPlayerSnapshot {
+	double mPositionX;
+	double mPositionY;
+	double mVelocityX;
+	double mVelocityY;
+	int32_t mState;
+	int32_t mTimeInState;
+	int32_t mAnimation;
+	int32_t mLife;
+	int32_t mPower;
+	int32_t mStateType;
+	int32_t mMoveType;
+	int32_t mFaceDirection;
+	int32_t mHelperAmount;
+	int32_t mProjectileAmount;
+	int32_t mVars[100];
+	int32_t mSystemVars[100];
+	double mFloatVars[100];
+	double mSystemFloatVars[100];
+};
+
+struct FightSyncSnapshot {
+	int32_t mFrame;
+	int32_t mGameTime;
+	int32_t mRandomState;
+	FightSyncPlayerSnapshot mPlayers[2];
+};
+
 static struct {
 	bool mHasReceivedNetplayData;
 	FightNetplayData mCachedReceivedNetplayData;
+
+	int32_t mFrame; // counts every netplay tick, unlike the game time which stands still during pauses
+	uint32_t mLastFrameHash;
+	FightSyncSnapshot mSnapshots[FIGHT_SYNC_CHECK_HISTORY_SIZE];
+
+	int32_t mDesyncFrame; // -1 until the hashes differ, then the frame whose snapshot is requested from the peer
+	uint32_t mDesyncLocalHash;
+	uint32_t mDesyncRemoteHash;
+	FightSyncSnapshot mDesyncSnapshot;
+	int32_t mRemoteRequestedSnapshotFrame;
+	int mHasDumpedDesync;
+
+	std::map<int32_t, std::vector<char>> mLoopbackLocalSyncCheckData; // gathered locally, waiting for the peer's data of the same frame
+	int mLoopbackCheckAmount;
+	int32_t mLoopbackFailedCheckFrame;
+	int mLoopbackMaximumCheckDelay;
 } gFightNetplayData;
 
+// only the hash of the latest frame is exchanged, the snapshot follows the header when the peer requested it
 struct FightSyncCheckData {
-	int mLife1;
-	int mLife2;
+	int32_t mLife1;
+	int32_t mLife2;
+	int32_t mFrame;
+	uint32_t mHash;
+	int32_t mRequestedSnapshotFrame;
+	int32_t mHasSnapshot;
 };
 
+static const uint32_t FNV_OFFSET_BASIS = 2166136261u;
+static const uint32_t FNV_PRIME = 16777619u;
+
+static void hashSyncCheckBytes(uint32_t* tHash, const void* tData, size_t tSize) {
+	const auto bytes = (const uint8_t*)tData;
+	for (size_t i = 0; i < tSize; i++) {
+		*tHash ^= bytes[i];
+		*tHash *= FNV_PRIME;
+	}
+}
+
+template<typename T>
+static void hashSyncCheckValue(uint32_t* tHash, const T& tValue) {
+	hashSyncCheckBytes(tHash, &tValue, sizeof(T));
+}
+
+static void hashSinglePlayerSyncState(uint32_t* tHash, DreamPlayer* p);
+
+static void hashSingleHelperSyncStateCB(void* tCaller, void* tData) {
+	hashSinglePlayerSyncState((uint32_t*)tCaller, (DreamPlayer*)tData);
+}
+
+static void hashSinglePlayerSyncState(uint32_t* tHash, DreamPlayer* p) {
+	const auto coordinateP = getPlayerCoordinateP(p);
+	hashSyncCheckValue(tHash, p->mID);
+	hashSyncCheckValue(tHash, getPlayerPositionX(p, coordinateP));
+	hashSyncCheckValue(tHash, getPlayerPositionY(p, coordinateP));
+	hashSyncCheckValue(tHash, getPlayerVelocityX(p, coordinateP));
+	hashSyncCheckValue(tHash, getPlayerVelocityY(p, coordinateP));
+	hashSyncCheckValue(tHash, getPlayerState(p));
+	hashSyncCheckValue(tHash, getPlayerTimeInState(p));
+	hashSyncCheckValue(tHash, getPlayerAnimationNumber(p));
+	hashSyncCheckValue(tHash, p->mLife);
+	hashSyncCheckValue(tHash, p->mPower);
+	hashSyncCheckValue(tHash, p->mStateType);
+	hashSyncCheckValue(tHash, p->mMoveType);
+	hashSyncCheckValue(tHash, p->mFaceDirection);
+	hashSyncCheckBytes(tHash, p->mVariables->mVars, sizeof(p->mVariables->mVars));
+	hashSyncCheckBytes(tHash, p->mVariables->mSystemVars, sizeof(p->mVariables->mSystemVars));
+	hashSyncCheckBytes(tHash, p->mVariables->mFloatVars, sizeof(p->mVariables->mFloatVars));
+	hashSyncCheckBytes(tHash, p->mVariables->mSystemFloatVars, sizeof(p->mVariables->mSystemFloatVars));
+	hashSyncCheckValue(tHash, list_size(&p->mHelpers));
+	hashSyncCheckValue(tHash, getPlayerProjectileAmount(p));
+
+	list_map(&p->mHelpers, hashSingleHelperSyncStateCB, tHash);
+}
+
+// prism keeps its generator state private, so a draw stands in for it and reseeds the generator with the drawn value.
+// Both sides stay in step as long as their states matched, and a diverged state shows up in the drawn value.
+static int32_t sampleFightRandomState() {
+	const auto value = randfromInteger(0, 0x7FFFFFFE);
+	setRandomSeed(unsigned(value) ^ (unsigned(gFightNetplayData.mFrame) * 2654435761u));
+	return value;
+}
+
+static uint32_t calculateFightSyncStateHash(int32_t tRandomState) {
+	uint32_t hash = FNV_OFFSET_BASIS;
+	hashSyncCheckValue(&hash, gFightNetplayData.mFrame);
+	hashSyncCheckValue(&hash, getDreamGameTime());
+	hashSyncCheckValue(&hash, tRandomState);
+	hashSinglePlayerSyncState(&hash, getRootPlayer(0));
+	hashSinglePlayerSyncState(&hash, getRootPlayer(1));
+	return hash;
+}
+
+static void captureSinglePlayerSyncSnapshot(FightSyncPlayerSnapshot* oSnapshot, DreamPlayer* p) {
+	const auto coordinateP = getPlayerCoordinateP(p);
+	oSnapshot->mPositionX = getPlayerPositionX(p, coordinateP);
+	oSnapshot->mPositionY = getPlayerPositionY(p, coordinateP);
+	oSnapshot->mVelocityX = getPlayerVelocityX(p, coordinateP);
+	oSnapshot->mVelocityY = getPlayerVelocityY(p, coordinateP);
+	oSnapshot->mState = getPlayerState(p);
+	oSnapshot->mTimeInState = getPlayerTimeInState(p);
+	oSnapshot->mAnimation = getPlayerAnimationNumber(p);
+	oSnapshot->mLife = p->mLife;
+	oSnapshot->mPower = p->mPower;
+	oSnapshot->mStateType = int32_t(p->mStateType);
+	oSnapshot->mMoveType = int32_t(p->mMoveType);
+	oSnapshot->mFaceDirection = int32_t(p->mFaceDirection);
+	oSnapshot->mHelperAmount = list_size(&p->mHelpers);
+	oSnapshot->mProjectileAmount = getPlayerProjectileAmount(p);
+	for (int i = 0; i < 100; i++) {
+		oSnapshot->mVars[i] = p->mVariables->mVars[i];
+		oSnapshot->mSystemVars[i] = p->mVariables->mSystemVars[i];
+		oSnapshot->mFloatVars[i] = p->mVariables->mFloatVars[i];
+		oSnapshot->mSystemFloatVars[i] = p->mVariables->mSystemFloatVars[i];
+	}
+}
+
+static void captureFightSyncSnapshot(FightSyncSnapshot* oSnapshot, int32_t tRandomState) {
+	oSnapshot->mFrame = gFightNetplayData.mFrame;
+	oSnapshot->mGameTime = getDreamGameTime();
+	oSnapshot->mRandomState = tRandomState;
+	captureSinglePlayerSyncSnapshot(&oSnapshot->mPlayers[0], getRootPlayer(0));
+	captureSinglePlayerSyncSnapshot(&oSnapshot->mPlayers[1], getRootPlayer(1));
+}
+
+static void dumpSinglePlayerSyncSnapshot(std::stringstream& ss, int tRootID, const FightSyncPlayerSnapshot& tSnapshot) {
+	ss << "[player " << tRootID << "]" << std::endl;
+	ss << "pos = " << tSnapshot.mPositionX << ", " << tSnapshot.mPositionY << std::endl;
+	ss << "vel = " << tSnapshot.mVelocityX << ", " << tSnapshot.mVelocityY << std::endl;
+	ss << "stateno = " << tSnapshot.mState << std::endl;
+	ss << "time = " << tSnapshot.mTimeInState << std::endl;
+	ss << "anim = " << tSnapshot.mAnimation << std::endl;
+	ss << "life = " << tSnapshot.mLife << std::endl;
+	ss << "power = " << tSnapshot.mPower << std::endl;
+	ss << "statetype = " << tSnapshot.mStateType << std::endl;
+	ss << "movetype = " << tSnapshot.mMoveType << std::endl;
+	ss << "facing = " << tSnapshot.mFaceDirection << std::endl;
+	ss << "helpers = " << tSnapshot.mHelperAmount << std::endl;
+	ss << "projectiles = " << tSnapshot.mProjectileAmount << std::endl;
+	for (int i = 0; i < 100; i++) {
+		if (tSnapshot.mVars[i]) ss << "var(" << i << ") = " << tSnapshot.mVars[i] << std::endl;
+	}
+	for (int i = 0; i < 100; i++) {
+		if (tSnapshot.mSystemVars[i]) ss << "sysvar(" << i << ") = " << tSnapshot.mSystemVars[i] << std::endl;
+	}
+	for (int i = 0; i < 100; i++) {
+		if (tSnapshot.mFloatVars[i]) ss << "fvar(" << i << ") = " << tSnapshot.mFloatVars[i] << std::endl;
+	}
+	for (int i = 0; i < 100; i++) {
+		if (tSnapshot.mSystemFloatVars[i]) ss << "sysfvar(" << i << ") = " << tSnapshot.mSystemFloatVars[i] << std::endl;
+	}
+	ss << std::endl;
+}
+
+static void dumpFightSyncSnapshot(std::stringstream& ss, const char* tName, const FightSyncSnapshot* tSnapshot, int tFrame) {
+	ss << "[" << tName << " state]" << std::endl;
+	if (!tSnapshot || tSnapshot->mFrame != tFrame) {
+		ss << "unavailable" << std::endl << std::endl;
+		return;
+	}
+	ss << "gametime = " << tSnapshot->mGameTime << std::endl;
+	ss << "random = " << tSnapshot->mRandomState << std::endl << std::endl;
+	dumpSinglePlayerSyncSnapshot(ss, 0, tSnapshot->mPlayers[0]);
+	dumpSinglePlayerSyncSnapshot(ss, 1, tSnapshot->mPlayers[1]);
+}
+static void dumpFightNetplayDesync(const FightSyncSnapshot* tRemoteSnapshot) {
+	if (gFightNetplayData.mHasDumpedDesync) return;
+	gFightNetplayData.mHasDumpedDesync = 1;
+
+	const auto desyncFrame = gFightNetplayData.mDesyncFrame;
+	std::stringstream ss;
+	ss << "[desync]" << std::endl;
+	ss << "frame = " << desyncFrame << std::endl;
+	ss << "currentframe = " << gFightNetplayData.mFrame << std::endl;
+	ss << "localhash = " << std::hex << gFightNetplayData.mDesyncLocalHash << std::endl;
+	ss << "remotehash = " << gFightNetplayData.mDesyncRemoteHash << std::dec << std::endl << std::endl;
+	dumpFightSyncSnapshot(ss, "local", &gFightNetplayData.mDesyncSnapshot, desyncFrame);
+	dumpFightSyncSnapshot(ss, "remote", tRemoteSnapshot, desyncFrame);
+
+	const auto path = std::string("debug/netplay_desync_").append(isDolmexicaNetplayHost() ? "host_" : "join_").append(std::to_string(desyncFrame)).append(".txt");
+	bufferToFile(path.c_str(), makeBuffer((void*)ss.str().c_str(), uint32_t(ss.str().size())));
+	logWarningFormat("Netplay desync at frame %d, dumped state to %s.", desyncFrame, path.c_str());
+}
+
+static const FightSyncSnapshot* findFightSyncSnapshot(int32_t tFrame) {
+	if (tFrame < 0) return NULL;
+	if (gFightNetplayData.mDesyncFrame == tFrame) return &gFightNetplayData.mDesyncSnapshot;
+	const auto& snapshot = gFightNetplayData.mSnapshots[tFrame % FIGHT_SYNC_CHECK_HISTORY_SIZE];
+	return snapshot.mFrame == tFrame ? &snapshot : NULL;
+}
+
 static Buffer gatherNetplaySyncCheckData(void*) {
 	Buffer b = makeBufferEmptyOwned();
 
+	// a recorded peer cannot answer requests later, so it hands over every snapshot up front
+	const auto snapshot = findFightSyncSnapshot(isDolmexicaNetplayLoopbackRecording() ? gFightNetplayData.mFrame - 1 : gFightNetplayData.mRemoteRequestedSnapshotFrame);
 	FightSyncCheckData syncCheckData;
 	syncCheckData.mLife1 = getPlayerLife(getRootPlayer(0));
 	syncCheckData.mLife2 = getPlayerLife(getRootPlayer(1));
+	syncCheckData.mFrame = gFightNetplayData.mFrame - 1;
+	syncCheckData.mHash = gFightNetplayData.mLastFrameHash;
+	syncCheckData.mRequestedSnapshotFrame = gFightNetplayData.mDesyncFrame;
+	syncCheckData.mHasSnapshot = snapshot != NULL;
 	appendBufferBuffer(&b, makeBuffer(&syncCheckData, sizeof(FightSyncCheckData)));
+	if (snapshot) {
+		appendBufferBuffer(&b, makeBuffer((void*)snapshot, sizeof(FightSyncSnapshot)));
+	}
 	return b;
 }
 
 static int checkNetplaySyncCheckData(void*, const Buffer& b1, const Buffer& b2) {
-	const auto checkData1 = (FightSyncCheckData*)b1.mData;
-	const auto checkData2 = (FightSyncCheckData*)b2.mData;
-	return checkData1->mLife1 == checkData2->mLife1 && checkData1->mLife2 == checkData2->mLife2;
+	if (b1.mLength < sizeof(FightSyncCheckData) || b2.mLength < sizeof(FightSyncCheckData)) {
+		logWarningFormat("Invalid netplay sync check sizes %d and %d.", int(b1.mLength), int(b2.mLength));
+		return 0;
+	}
+	FightSyncCheckData localData, remoteData;
+	memcpy(&localData, b1.mData, sizeof(FightSyncCheckData));
+	memcpy(&remoteData, b2.mData, sizeof(FightSyncCheckData));
+	gFightNetplayData.mRemoteRequestedSnapshotFrame = remoteData.mRequestedSnapshotFrame;
+
+	FightSyncSnapshot remoteSnapshot;
+	const auto hasRemoteSnapshot = remoteData.mHasSnapshot && b2.mLength >= sizeof(FightSyncCheckData) + sizeof(FightSyncSnapshot);
+	if (hasRemoteSnapshot) {
+		memcpy(&remoteSnapshot, (const char*)b2.mData + sizeof(FightSyncCheckData), sizeof(FightSyncSnapshot));
+	}
+
+	if (gFightNetplayData.mDesyncFrame != -1) {
+		// the exchange after the mismatch carries the requested snapshot, unless the peer no longer had it
+		dumpFightNetplayDesync(hasRemoteSnapshot ? &remoteSnapshot : NULL);
+		return 0;
+	}
+
+	if (localData.mFrame >= 0 && localData.mFrame == remoteData.mFrame && localData.mHash != remoteData.mHash) {
+		const auto localSnapshot = findFightSyncSnapshot(localData.mFrame);
+		if (!localSnapshot) return 0;
+		gFightNetplayData.mDesyncSnapshot = *localSnapshot;
+		gFightNetplayData.mDesyncFrame = localData.mFrame;
+		gFightNetplayData.mDesyncLocalHash = localData.mHash;
+		gFightNetplayData.mDesyncRemoteHash = remoteData.mHash;
+		if (hasRemoteSnapshot && remoteSnapshot.mFrame == localData.mFrame) {
+			dumpFightNetplayDesync(&remoteSnapshot);
+			return 0;
+		}
+		logWarningFormat("Netplay state hash mismatch at frame %d, requesting the peer's snapshot.", localData.mFrame);
+		return 1; // kept alive for one more exchange so the peer's snapshot arrives
+	}
+	return localData.mLife1 == remoteData.mLife1 && localData.mLife2 == remoteData.mLife2;
+}
+
+static void resetFightNetplayFrameHashes() {
+	for (int i = 0; i < FIGHT_SYNC_CHECK_HISTORY_SIZE; i++) {
+		gFightNetplayData.mSnapshots[i].mFrame = -1;
+	}
+	gFightNetplayData.mFrame = 0;
+	gFightNetplayData.mLastFrameHash = 0;
+	gFightNetplayData.mDesyncFrame = -1;
+	gFightNetplayData.mDesyncSnapshot.mFrame = -1;
+	gFightNetplayData.mRemoteRequestedSnapshotFrame = -1;
+	gFightNetplayData.mHasDumpedDesync = 0;
 }
 
 static void initFightNetplay(void*) {
 	gFightNetplayData.mHasReceivedNetplayData = false;
+	resetFightNetplayFrameHashes();
+	gFightNetplayData.mLoopbackLocalSyncCheckData.clear();
+	gFightNetplayData.mLoopbackCheckAmount = 0;
+	gFightNetplayData.mLoopbackFailedCheckFrame = -1;
+	gFightNetplayData.mLoopbackMaximumCheckDelay = 0;
 	setNetplaySyncCBs(gatherNetplaySyncCheckData, NULL, checkNetplaySyncCheckData, NULL);
 }
 
@@ -44,6 +325,59 @@ static void shutdownFightNetplay(void*) {
 	setNetplaySyncCBs(NULL, NULL, NULL, NULL);
 }
 
+// the loopback stands in for prism's sync exchange: the gathered data travels through the simulated connection
+// and is checked against the peer's data of the same frame with the same callbacks prism uses
+static void sendFightNetplayLoopbackSyncCheck() {
+	if (gFightNetplayData.mFrame % FIGHT_NETPLAY_LOOPBACK_SYNC_CHECK_INTERVAL) return;
+
+	auto b = gatherNetplaySyncCheckData(NULL);
+	const auto data = (const char*)b.mData;
+	gFightNetplayData.mLoopbackLocalSyncCheckData[gFightNetplayData.mFrame - 1] = std::vector<char>(data, data + b.mLength);
+	sendDolmexicaNetplayData(b);
+	freeBuffer(b);
+}
+
+static void checkFightNetplayLoopbackSyncData(const Buffer& tRemoteData) {
+	if (tRemoteData.mLength < sizeof(FightSyncCheckData)) return;
+	FightSyncCheckData remoteData;
+	memcpy(&remoteData, tRemoteData.mData, sizeof(FightSyncCheckData));
+
+	auto& localSyncCheckData = gFightNetplayData.mLoopbackLocalSyncCheckData;
+	const auto it = localSyncCheckData.find(remoteData.mFrame);
+	if (it == localSyncCheckData.end()) return;
+
+	const auto localData = makeBuffer(it->second.data(), uint32_t(it->second.size()));
+	const auto isInSync = checkNetplaySyncCheckData(NULL, localData, tRemoteData);
+	gFightNetplayData.mLoopbackCheckAmount++;
+	gFightNetplayData.mLoopbackMaximumCheckDelay = std::max(gFightNetplayData.mLoopbackMaximumCheckDelay, int(gFightNetplayData.mFrame - 1 - remoteData.mFrame));
+	if (gFightNetplayData.mLoopbackFailedCheckFrame == -1) {
+		if (gFightNetplayData.mDesyncFrame != -1) gFightNetplayData.mLoopbackFailedCheckFrame = gFightNetplayData.mDesyncFrame;
+		else if (!isInSync) gFightNetplayData.mLoopbackFailedCheckFrame = remoteData.mFrame;
+	}
+	localSyncCheckData.erase(localSyncCheckData.begin(), std::next(it));
+}
+
+static void updateFightNetplayLoopback() {
+	if (!isDolmexicaNetplayLoopbackActive()) return;
+
+	sendFightNetplayLoopbackSyncCheck();
+	updateDolmexicaNetplayLoopback();
+	while (hasDolmexicaNetplayLoopbackData()) {
+		auto b = popDolmexicaNetplayLoopbackData();
+		checkFightNetplayLoopbackSyncData(b);
+		freeBuffer(b);
+	}
+}
+
+static void updateFightNetplay(void*) {
+	const auto randomState = sampleFightRandomState();
+	gFightNetplayData.mLastFrameHash = calculateFightSyncStateHash(randomState);
+	captureFightSyncSnapshot(&gFightNetplayData.mSnapshots[gFightNetplayData.mFrame % FIGHT_SYNC_CHECK_HISTORY_SIZE], randomState);
+	gFightNetplayData.mFrame++;
+
+	updateFightNetplayLoopback();
+}
+
 int hasNewFightNetplayReceivedData() {
 	return gFightNetplayData.mHasReceivedNetplayData;
 }
@@ -55,9 +389,21 @@ FightNetplayData popFightNetplayReceivedData() {
 }
 
 void sendFightNetplayData(const Buffer& tData) {
-	sendNetplayData(tData);
+	sendDolmexicaNetplayData(tData);
+}
+
+int getFightNetplayLoopbackCheckAmount() {
+	return gFightNetplayData.mLoopbackCheckAmount;
+}
+
+int getFightNetplayLoopbackFailedCheckFrame() {
+	return gFightNetplayData.mLoopbackFailedCheckFrame;
+}
+
+int getFightNetplayLoopbackMaximumCheckDelay() {
+	return gFightNetplayData.mLoopbackMaximumCheckDelay;
 }
 
 ActorBlueprint getFightNetplayBlueprint() {
-	return makeActorBlueprint(initFightNetplay, shutdownFightNetplay);
-}
\ No newline at end of file
+	return makeActorBlueprint(initFightNetplay, shutdownFightNetplay, updateFightNetplay);
+}
@@ -8,6 +8,8 @@
 
 using namespace prism;
 
+#define FIGHT_NETPLAY_RANDOM_SEED 0u
+
 struct FightNetplaySingleCommandSent{
 	std::string mName;
 	int mIsActive;
@@ -24,5 +26,8 @@ int hasNewFightNetplayReceivedData();
 FightNetplayData popFightNetplayReceivedData();
 
 void sendFightNetplayData(const Buffer& tData);
+int getFightNetplayLoopbackCheckAmount();
+int getFightNetplayLoopbackFailedCheckFrame();
+int getFightNetplayLoopbackMaximumCheckDelay();
 
 ActorBlueprint getFightNetplayBlueprint();
\ No newline at end of file
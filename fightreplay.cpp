@@ -0,0 +1,297 @@
+#include "fightreplay.h"
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <prism/file.h>
+#include <prism/log.h>
+#include <prism/math.h>
+#include <prism/system.h>
+
+#include "playerdefinition.h"
+#include "stage.h"
+#include "config.h"
+#include "gamelogic.h"
+
+using namespace prism;
+
+#define FIGHT_REPLAY_VERSION 1u
+
+typedef enum {
+	FIGHT_REPLAY_STATE_INACTIVE,
+	FIGHT_REPLAY_STATE_RECORDING_ARMED,
+	FIGHT_REPLAY_STATE_RECORDING,
+	FIGHT_REPLAY_STATE_PLAYBACK_ARMED,
+	FIGHT_REPLAY_STATE_PLAYING,
+} FightReplayState;
+
+struct FightReplayFrame {
+	uint32_t mMask[2];
+};
+
+struct FightReplayHeader {
+	uint32_t mSeed;
+	std::string mPlayerDefinitionPaths[2];
+	int32_t mPlayerPalettes[2];
+	std::string mStagePath;
+	std::string mStageMusicPath;
+
+	int32_t mDifficulty;
+	int32_t mLifeStartPercentageNumber;
+	int32_t mIsTimerInfinite;
+	int32_t mTimerDuration;
+	int32_t mGameSpeed;
+};
+
+static struct {
+	FightReplayState mState;
+	std::string mRecordingPath;
+
+	FightReplayHeader mHeader;
+	std::vector<FightReplayFrame> mFrames;
+	size_t mPlaybackPosition;
+
+	int mHasSavedOptions;
+	FightReplayHeader mSavedOptions; // options overwritten by a replay setup, restored once the fight is over
+} gFightReplayData;
+
+void armFightReplayRecording(const char* tPath)
+{
+	gFightReplayData.mState = FIGHT_REPLAY_STATE_RECORDING_ARMED;
+	gFightReplayData.mRecordingPath = tPath;
+}
+
+static void appendFightReplayString(Buffer* b, const std::string& tString) {
+	appendBufferUint32(b, uint32_t(tString.size()));
+	appendBufferString(b, tString.c_str(), int(tString.size()));
+}
+
+static int hasFightReplayBytesLeft(BufferPointer p, BufferPointer tEnd, uint64_t tSize) {
+	return tEnd >= p && uint64_t(tEnd - p) >= tSize;
+}
+
+static int readFightReplayValue(BufferPointer* p, BufferPointer tEnd, void* oValue, size_t tSize) {
+	if (!hasFightReplayBytesLeft(*p, tEnd, tSize)) return 0;
+	readFromBufferPointer(oValue, p, tSize);
+	return 1;
+}
+
+static int readFightReplayString(BufferPointer* p, BufferPointer tEnd, std::string* oString) {
+	uint32_t len;
+	if (!readFightReplayValue(p, tEnd, &len, sizeof(uint32_t))) return 0;
+	if (!hasFightReplayBytesLeft(*p, tEnd, len)) return 0;
+	std::vector<char> readBuffer(len + 2, '\0');
+	readFromBufferPointer(readBuffer.data(), p, len);
+	*oString = std::string(readBuffer.data());
+	return 1;
+}
+
+static void captureFightReplayHeader(FightReplayHeader* tHeader, uint32_t tSeed) {
+	auto& header = *tHeader;
+	char path[1024];
+	char musicPath[1024];
+
+	header.mSeed = tSeed;
+	for (int i = 0; i < 2; i++) {
+		getPlayerDefinitionPath(path, i);
+		header.mPlayerDefinitionPaths[i] = path;
+		header.mPlayerPalettes[i] = getPlayerPreferredPalette(i);
+	}
+	getDreamStageMugenDefinition(path, musicPath);
+	header.mStagePath = path;
+	header.mStageMusicPath = musicPath;
+
+	header.mDifficulty = getDifficulty();
+	header.mLifeStartPercentageNumber = getLifeStartPercentageNumber();
+	header.mIsTimerInfinite = isGlobalTimerInfinite();
+	header.mTimerDuration = getGlobalTimerDuration();
+	header.mGameSpeed = getGlobalGameSpeed();
+}
+
+static void writeFightReplayHeader(Buffer* b, const FightReplayHeader& header) {
+	appendBufferUint32(b, header.mSeed);
+	for (int i = 0; i < 2; i++) {
+		appendFightReplayString(b, header.mPlayerDefinitionPaths[i]);
+		appendBufferInt32(b, header.mPlayerPalettes[i]);
+	}
+	appendFightReplayString(b, header.mStagePath);
+	appendFightReplayString(b, header.mStageMusicPath);
+	appendBufferInt32(b, header.mDifficulty);
+	appendBufferInt32(b, header.mLifeStartPercentageNumber);
+	appendBufferInt32(b, header.mIsTimerInfinite);
+	appendBufferInt32(b, header.mTimerDuration);
+	appendBufferInt32(b, header.mGameSpeed);
+}
+
+static int readFightReplayHeader(BufferPointer* p, BufferPointer tEnd, FightReplayHeader* tHeader) {
+	auto& header = *tHeader;
+	if (!readFightReplayValue(p, tEnd, &header.mSeed, sizeof(uint32_t))) return 0;
+	for (int i = 0; i < 2; i++) {
+		if (!readFightReplayString(p, tEnd, &header.mPlayerDefinitionPaths[i])) return 0;
+		if (!readFightReplayValue(p, tEnd, &header.mPlayerPalettes[i], sizeof(int32_t))) return 0;
+	}
+	if (!readFightReplayString(p, tEnd, &header.mStagePath)) return 0;
+	if (!readFightReplayString(p, tEnd, &header.mStageMusicPath)) return 0;
+	if (!readFightReplayValue(p, tEnd, &header.mDifficulty, sizeof(int32_t))) return 0;
+	if (!readFightReplayValue(p, tEnd, &header.mLifeStartPercentageNumber, sizeof(int32_t))) return 0;
+	if (!readFightReplayValue(p, tEnd, &header.mIsTimerInfinite, sizeof(int32_t))) return 0;
+	if (!readFightReplayValue(p, tEnd, &header.mTimerDuration, sizeof(int32_t))) return 0;
+	return readFightReplayValue(p, tEnd, &header.mGameSpeed, sizeof(int32_t));
+}
+
+static void saveFightReplay() {
+	Buffer b = makeBufferEmptyOwned();
+
+	appendBufferUint32(&b, FIGHT_REPLAY_VERSION);
+	writeFightReplayHeader(&b, gFightReplayData.mHeader);
+
+	appendBufferUint32(&b, uint32_t(gFightReplayData.mFrames.size()));
+	for (const auto& frame : gFightReplayData.mFrames) {
+		appendBufferUint32(&b, frame.mMask[0]);
+		appendBufferUint32(&b, frame.mMask[1]);
+	}
+
+	bufferToFile(gFightReplayData.mRecordingPath.c_str(), b);
+	freeBuffer(b);
+	logFormat("Saved replay with %d frames to %s.", int(gFightReplayData.mFrames.size()), gFightReplayData.mRecordingPath.c_str());
+}
+
+static void applyFightReplayOptions(const FightReplayHeader& header) {
+	setDifficulty(header.mDifficulty);
+	setLifeStartPercentageNumber(header.mLifeStartPercentageNumber);
+	if (header.mIsTimerInfinite) {
+		setGlobalTimerInfinite();
+	}
+	else {
+		setGlobalTimerDuration(header.mTimerDuration);
+	}
+	setGlobalGameSpeed(header.mGameSpeed);
+}
+
+static void applyFightReplayHeader(const FightReplayHeader& header) {
+	for (int i = 0; i < 2; i++) {
+		setPlayerDefinitionPath(i, header.mPlayerDefinitionPaths[i].c_str());
+		setPlayerPreferredPalette(i, header.mPlayerPalettes[i]);
+	}
+	setDreamStageMugenDefinition(header.mStagePath.c_str(), header.mStageMusicPath.c_str());
+
+	if (!gFightReplayData.mHasSavedOptions) {
+		captureFightReplayHeader(&gFightReplayData.mSavedOptions, 0);
+		gFightReplayData.mHasSavedOptions = 1;
+	}
+	applyFightReplayOptions(header);
+}
+
+static void restoreFightReplayOptions() {
+	if (!gFightReplayData.mHasSavedOptions) return;
+	applyFightReplayOptions(gFightReplayData.mSavedOptions);
+	gFightReplayData.mHasSavedOptions = 0;
+}
+
+int loadFightReplay(const char* tPath)
+{
+	if (!isFile(tPath)) {
+		logWarningFormat("Unable to find replay file %s.", tPath);
+		return 0;
+	}
+
+	auto b = fileToBuffer(tPath);
+	auto p = getBufferPointer(b);
+	const auto end = p + b.mLength;
+
+	uint32_t version;
+	if (!readFightReplayValue(&p, end, &version, sizeof(uint32_t)) || version != FIGHT_REPLAY_VERSION) {
+		logWarningFormat("Replay %s has invalid version. Aborting load.", tPath);
+		freeBuffer(b);
+		return 0;
+	}
+
+	uint32_t frameAmount;
+	if (!readFightReplayHeader(&p, end, &gFightReplayData.mHeader) || !readFightReplayValue(&p, end, &frameAmount, sizeof(uint32_t)) || !hasFightReplayBytesLeft(p, end, uint64_t(frameAmount) * 2 * sizeof(uint32_t))) {
+		logWarningFormat("Replay %s is truncated. Aborting load.", tPath);
+		freeBuffer(b);
+		return 0;
+	}
+
+	gFightReplayData.mFrames.resize(frameAmount);
+	for (auto& frame : gFightReplayData.mFrames) {
+		readFromBufferPointer(&frame.mMask[0], &p, sizeof(uint32_t));
+		readFromBufferPointer(&frame.mMask[1], &p, sizeof(uint32_t));
+	}
+	freeBuffer(b);
+
+	applyFightReplayHeader(gFightReplayData.mHeader);
+	gFightReplayData.mState = FIGHT_REPLAY_STATE_PLAYBACK_ARMED;
+	return 1;
+}
+
+void startFightReplayForFight()
+{
+	if (gFightReplayData.mState == FIGHT_REPLAY_STATE_RECORDING_ARMED) {
+		// only controller inputs are recorded, so AI decisions and mode-specific setup would not play back
+		if (getGameMode() != GAME_MODE_VERSUS || !isPlayerHuman(getRootPlayer(0)) || !isPlayerHuman(getRootPlayer(1))) {
+			logWarning("Replays can only be recorded for versus fights between two human players. Recording disarmed.");
+			gFightReplayData.mState = FIGHT_REPLAY_STATE_INACTIVE;
+			return;
+		}
+		const auto seed = uint32_t(getSystemTicks());
+		captureFightReplayHeader(&gFightReplayData.mHeader, seed);
+		gFightReplayData.mFrames.clear();
+		gFightReplayData.mState = FIGHT_REPLAY_STATE_RECORDING;
+	}
+	else if (gFightReplayData.mState == FIGHT_REPLAY_STATE_PLAYBACK_ARMED) {
+		gFightReplayData.mPlaybackPosition = 0;
+		gFightReplayData.mState = FIGHT_REPLAY_STATE_PLAYING;
+	}
+}
+
+void finishFightReplayForFight()
+{
+	if (gFightReplayData.mState == FIGHT_REPLAY_STATE_RECORDING) {
+		saveFightReplay();
+	}
+	if (gFightReplayData.mState == FIGHT_REPLAY_STATE_RECORDING || gFightReplayData.mState == FIGHT_REPLAY_STATE_PLAYING) {
+		gFightReplayData.mFrames.clear();
+		gFightReplayData.mState = FIGHT_REPLAY_STATE_INACTIVE;
+	}
+	restoreFightReplayOptions();
+}
+
+int isFightReplayRecording()
+{
+	return gFightReplayData.mState == FIGHT_REPLAY_STATE_RECORDING;
+}
+
+int isFightReplayPlaying()
+{
+	return gFightReplayData.mState == FIGHT_REPLAY_STATE_PLAYING;
+}
+
+void recordFightReplayInputMasks(uint32_t tMask1, uint32_t tMask2)
+{
+	FightReplayFrame frame;
+	frame.mMask[0] = tMask1;
+	frame.mMask[1] = tMask2;
+	gFightReplayData.mFrames.push_back(frame);
+}
+
+int popFightReplayInputMasks(uint32_t* oMask1, uint32_t* oMask2)
+{
+	if (gFightReplayData.mPlaybackPosition >= gFightReplayData.mFrames.size()) {
+		*oMask1 = *oMask2 = 0;
+		return 0;
+	}
+
+	const auto& frame = gFightReplayData.mFrames[gFightReplayData.mPlaybackPosition++];
+	*oMask1 = frame.mMask[0];
+	*oMask2 = frame.mMask[1];
+	return 1;
+}
+
+int getFightReplaySeed(uint32_t* oSeed)
+{
+	if (!isFightReplayRecording() && !isFightReplayPlaying()) return 0;
+	*oSeed = gFightReplayData.mHeader.mSeed;
+	return 1;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stdint.h>
+
+void armFightReplayRecording(const char* tPath);
+int loadFightReplay(const char* tPath);
+
+void startFightReplayForFight();
+void finishFightReplayForFight();
+
+int isFightReplayRecording();
+int isFightReplayPlaying();
+void recordFightReplayInputMasks(uint32_t tMask1, uint32_t tMask2);
+int popFightReplayInputMasks(uint32_t* oMask1, uint32_t* oMask2);
+int getFightReplaySeed(uint32_t* oSeed);
@@ -14,6 +14,7 @@
 #include <prism/debug.h>
 #include <prism/netplay.h>
 #include <prism/log.h>
+#include <prism/math.h>
 
 #include "stage.h"
 #include "mugencommandreader.h"
@@ -41,9 +42,12 @@
 #include "mugensound.h"
 #include "pausecontrollers.h"
 #include "trainingmodemenu.h"
+#include "trainingmoderewind.h"
 #include "storyhelper.h"
 #include "dolmexicastoryscreen.h"
 #include "fightnetplay.h"
+#include "fightreplay.h"
+#include "matchprefetch.h"
 
 static struct {
 	void(*mWinCB)();
@@ -76,8 +80,21 @@ extern int gPruneAmount;
 
 static void exitFightScreenCB(void* tCaller);
 
+// the only place a fight seeds the random state, replays use their recorded seed and both netplay peers a shared one
+static void seedFightRandomState() {
+	uint32_t seed;
+	if (getFightReplaySeed(&seed)) {
+		setRandomSeed(seed);
+	}
+	else if (getGameMode() == GAME_MODE_NETPLAY) {
+		setRandomSeed(FIGHT_NETPLAY_RANDOM_SEED);
+	}
+}
+
 static void loadFightScreen() {
 	setWrapperBetweenScreensCB(exitFightScreenCB, NULL);
+	startFightReplayForFight();
+	seedFightRandomState();
 
 	logMemoryState();
 	logg("create mem stack");
@@ -159,6 +176,7 @@ static void loadFightScreen() {
 	if (getGameMode() == GAME_MODE_TRAINING) {
 		int actorID = instantiateActor(getTrainingModeMenu());
 		setActorUnpausable(actorID);
+		instantiateActor(getTrainingModeRewindHandler());
 	}
 
 	setFightScreenGameSpeed();
@@ -168,7 +186,7 @@ static void loadFightScreen() {
 	setPlayerStatemachineToUpdateAgain(getRootPlayer(0));
 	setPlayerStatemachineToUpdateAgain(getRootPlayer(1));
 
-	
+	startArmedMatchPrefetch();
 
 	logMemoryState();
 
@@ -180,6 +198,7 @@ static void loadFightScreen() {
 }
 
 static void unloadFightScreen() {
+	finishFightReplayForFight();
 	unloadPlayers();
 	resetGameMode();
 	shutdownDreamMugenStateControllerHandler();
@@ -0,0 +1,131 @@
+#include "matchprefetch.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <prism/file.h>
+#include <prism/log.h>
+#include <prism/mugendefreader.h>
+
+#include "config.h"
+
+#if defined (_WIN32) || defined(VITA)
+#include <atomic>
+#include <memory>
+#include <thread>
+#endif
+
+using namespace prism;
+
+#define MATCH_PREFETCH_BYTE_BUDGET (64 * 1024 * 1024)
+#define MATCH_PREFETCH_CHUNK_SIZE (64 * 1024)
+
+static struct {
+	std::vector<std::string> mArmedFiles; // resolved paths, read by the worker without touching prism
+#if defined (_WIN32) || defined(VITA)
+	std::shared_ptr<std::atomic<int>> mActiveJobCancellation;
+#endif
+} gMatchPrefetchData;
+
+static void addMatchPrefetchFile(const std::string& tPath) {
+	if (!isFile(tPath)) return;
+
+	char fullPath[1024];
+	getFullPath(fullPath, tPath.c_str());
+	gMatchPrefetchData.mArmedFiles.push_back(fullPath);
+}
+
+static void addCharacterFilesToMatchPrefetch(const char* tDefinitionPath) {
+	if (!isFile(tDefinitionPath)) return;
+
+	static const char* FILE_KEYS[] = { "cmd", "cns", "stcommon", "st", "anim", "sprite", "sound" };
+	char folder[1024];
+	getPathToFile(folder, tDefinitionPath);
+	MugenDefScript script;
+	loadMugenDefScript(&script, tDefinitionPath);
+	for (const auto key : FILE_KEYS) {
+		const auto file = getSTLMugenDefStringOrDefault(&script, "files", key, "");
+		if (file.empty()) continue;
+		addMatchPrefetchFile(std::string(folder) + file);
+	}
+	unloadMugenDefScript(&script);
+}
+
+static void addStageFilesToMatchPrefetch(const char* tStagePath) {
+	if (!tStagePath || !isFile(tStagePath)) return;
+
+	char folder[1024];
+	getPathToFile(folder, tStagePath);
+	MugenDefScript script;
+	loadMugenDefScript(&script, tStagePath);
+	const auto spritePath = getSTLMugenDefStringOrDefault(&script, "bgdef", "spr", "");
+	if (!spritePath.empty()) {
+		if (isFile(std::string(folder) + spritePath)) {
+			addMatchPrefetchFile(std::string(folder) + spritePath);
+		}
+		else {
+			addMatchPrefetchFile(getDolmexicaAssetFolder() + spritePath);
+		}
+	}
+	unloadMugenDefScript(&script);
+}
+
+void armMatchPrefetch(const char* tCharacterDefinitionPath, const char* tStagePath)
+{
+	gMatchPrefetchData.mArmedFiles.clear();
+	addMatchPrefetchFile(tCharacterDefinitionPath);
+	addMatchPrefetchFile(std::string(tCharacterDefinitionPath) + ".pak");
+	addCharacterFilesToMatchPrefetch(tCharacterDefinitionPath);
+	addStageFilesToMatchPrefetch(tStagePath);
+}
+
+#if defined (_WIN32) || defined(VITA)
+static void runMatchPrefetchJob(std::vector<std::string> tFiles, std::shared_ptr<std::atomic<int>> tIsCancelled) {
+	std::vector<char> buffer(MATCH_PREFETCH_CHUNK_SIZE);
+	size_t bytesLeft = MATCH_PREFETCH_BYTE_BUDGET;
+	for (const auto& path : tFiles) {
+		FILE* file = fopen(path.c_str(), "rb");
+		if (!file) continue;
+
+		while (bytesLeft && !*tIsCancelled) {
+			const auto readSize = fread(buffer.data(), 1, std::min(buffer.size(), bytesLeft), file);
+			if (!readSize) break;
+			bytesLeft -= readSize;
+		}
+		fclose(file);
+
+		if (!bytesLeft || *tIsCancelled) return;
+	}
+}
+#endif
+
+static void cancelActiveMatchPrefetchJob() {
+#if defined (_WIN32) || defined(VITA)
+	if (gMatchPrefetchData.mActiveJobCancellation) {
+		*gMatchPrefetchData.mActiveJobCancellation = 1;
+		gMatchPrefetchData.mActiveJobCancellation = nullptr;
+	}
+#endif
+}
+
+void startArmedMatchPrefetch()
+{
+	if (gMatchPrefetchData.mArmedFiles.empty()) return;
+	cancelActiveMatchPrefetchJob();
+
+#if defined (_WIN32) || defined(VITA)
+	auto isCancelled = std::make_shared<std::atomic<int>>(0);
+	gMatchPrefetchData.mActiveJobCancellation = isCancelled;
+	std::thread(runMatchPrefetchJob, gMatchPrefetchData.mArmedFiles, isCancelled).detach();
+	logFormat("Prefetching %d files for the next match.", int(gMatchPrefetchData.mArmedFiles.size()));
+#endif
+	gMatchPrefetchData.mArmedFiles.clear();
+}
+
+void cancelMatchPrefetch()
+{
+	cancelActiveMatchPrefetchJob();
+	gMatchPrefetchData.mArmedFiles.clear();
+}
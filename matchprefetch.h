@@ -0,0 +1,5 @@
+#pragma once
+
+void armMatchPrefetch(const char* tCharacterDefinitionPath, const char* tStagePath);
+void startArmedMatchPrefetch();
+void cancelMatchPrefetch();
@@ -2,6 +2,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <ctype.h>
 #include <assert.h>
 #include <math.h>
 
@@ -643,10 +644,57 @@ static int isComparisonGroup(const char* tText) {
 	return isOnHighestLevelBinaryMultipleRightToLeft(tText, patterns, 1, NULL, NULL);
 }
 
+static int isHitDefAttributeComparisonVariable(const char* tText) {
+	string text = tText;
+	const auto commaPosition = text.rfind(',');
+	if (commaPosition != string::npos) text = text.substr(commaPosition + 1); // redirected, e.g. "p2, hitdefattr"
+	const auto start = text.find_first_not_of(" \t");
+	if (start == string::npos) return 0;
+	text = text.substr(start, text.find_last_not_of(" \t") - start + 1);
+	turnStringLowercase(&text[0]);
+	return text == "hitdefattr";
+}
+
+static int isLiteralHitDefAttributeString(const char* tText) {
+	for (; *tText; tText++) {
+		if (!isalpha(*tText) && *tText != ',' && *tText != ' ') return 0;
+	}
+	return 1;
+}
+
+static DreamMugenAssignment* parseMugenRawVariableFromString(char* tText);
+
+static DreamMugenAssignment* parseMugenHitDefAttributeComparisonFromString(char* tText, DreamMugenAssignmentType tType, const char* tPattern, int tPosition) {
+	char text1[MUGEN_DEF_STRING_LENGTH];
+	strcpy(text1, tText);
+	text1[tPosition] = '\0';
+	const char* text2 = &tText[tPosition + strlen(tPattern)];
+
+	char compiledName[] = MUGEN_COMPILED_HIT_DEF_ATTRIBUTE_VARIABLE_NAME;
+	DreamMugenAssignment* a = parseMugenRawVariableFromString(compiledName);
+	char* commaPosition = strrchr(text1, ',');
+	if (commaPosition) { // redirected, e.g. "p2, hitdefattr"
+		*commaPosition = '\0';
+		a = makeMugenTwoElementAssignment(MUGEN_ASSIGNMENT_TYPE_VECTOR, parseDreamMugenAssignmentFromString(text1), a);
+	}
+	DreamMugenAssignment* b = makeDreamNumberMugenAssignment(int(compileHitDefAttributeString(text2)));
+	return makeMugenTwoElementAssignment(tType, a, b);
+}
+
 static DreamMugenAssignment* parseMugenComparisonGroupFromString(char* tText) {
 	std::vector<std::tuple<int(*)(const char*, int, int), DreamMugenAssignmentType, std::string>> patterns;
 	patterns.push_back(std::make_tuple(isEqualityCharacter, MUGEN_ASSIGNMENT_TYPE_COMPARISON, "="));
 	patterns.push_back(std::make_tuple(isInequalityCharacter, MUGEN_ASSIGNMENT_TYPE_INEQUALITY, "!="));
+
+	int pos = -1;
+	int index = -1;
+	isOnHighestLevelBinaryMultipleRightToLeft(tText, patterns, 1, &pos, &index);
+	const auto& pattern = std::get<2>(patterns[index]);
+	string variableText(tText, pos);
+	if (isHitDefAttributeComparisonVariable(variableText.c_str()) && isLiteralHitDefAttributeString(tText + pos + pattern.size())) {
+		return parseMugenHitDefAttributeComparisonFromString(tText, std::get<1>(patterns[index]), pattern.c_str(), pos);
+	}
+
 	return parseBinaryTwoElementMultipleRightToLeftMugenAssignmentFromString(tText, patterns, 1);
 }
 
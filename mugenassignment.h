@@ -8,6 +8,9 @@
 
 using namespace prism;
 
+// only produced by the parser for hitdefattr comparisons with a literal attribute string, the right-hand side then holds compiled attribute flags
+#define MUGEN_COMPILED_HIT_DEF_ATTRIBUTE_VARIABLE_NAME "hitdefattr compiled"
+
 typedef enum {
 	MUGEN_ASSIGNMENT_RETURN_TYPE_STRING,
 	MUGEN_ASSIGNMENT_RETURN_TYPE_NUMBER,
@@ -960,53 +960,8 @@ static AssignmentReturnValue* evaluateSetVariableAssignment(DreamMugenAssignment
 	}
 }
 
-static int evaluateSingleHitDefAttributeFlag2(char* tFlag, MugenAttackClass tClass, MugenAttackType tType) {
-	turnStringLowercase(tFlag);
-
-	if (strlen(tFlag) != 2) {
-		logWarningFormat("Invalid hitdef attribute flag %s. Default to false.", tFlag);
-		return 0;
-	}
-
-	int isPart1OK;
-	if (tFlag[0] == 'a') {
-		isPart1OK = 1;
-	}
-	else if (tClass == MUGEN_ATTACK_CLASS_NORMAL) {
-		isPart1OK = tFlag[0] == 'n';
-	} else if (tClass == MUGEN_ATTACK_CLASS_SPECIAL) {
-		isPart1OK = tFlag[0] == 's';
-	}
-	else if (tClass == MUGEN_ATTACK_CLASS_HYPER) {
-		isPart1OK = tFlag[0] == 'h';
-	}
-	else {
-		logWarningFormat("Unrecognized attack class %d. Default to false.", tClass);
-		isPart1OK = 0;
-	}
-
-	if (!isPart1OK) return 0;
-
-	int isPart2OK;
-	if (tType == MUGEN_ATTACK_TYPE_ATTACK) {
-		isPart2OK = tFlag[1] == 'a';
-	}
-	else if (tType == MUGEN_ATTACK_TYPE_PROJECTILE) {
-		isPart2OK = tFlag[1] == 'p';
-	}
-	else if (tType == MUGEN_ATTACK_TYPE_THROW) {
-		isPart2OK = tFlag[1] == 't';
-	}
-	else {
-		logWarningFormat("Unrecognized attack type %d. Default to false.", tType);
-		isPart2OK = 0;
-	}
-
-	return isPart2OK;
-}
-
 static AssignmentReturnValue* evaluateHitDefAttributeAssignment(AssignmentReturnValue* tValue, DreamPlayer* tPlayer, int* tIsStatic) {
-
+	*tIsStatic = 0;
 	if (!isHitDataActive(tPlayer)) {
 		destroyAssignmentReturn(tValue);
 		return makeBooleanAssignmentReturn(0);
@@ -1014,63 +969,18 @@ static AssignmentReturnValue* evaluateHitDefAttributeAssignment(AssignmentReturn
 
 	string test;
 	convertAssignmentReturnToString(test, tValue);
-	const char* pos = test.data();
-	int positionsRead;
-	char flag[10], comma[10];
-	int items = sscanf(pos, "%s %s%n", flag, comma, &positionsRead);
-	pos += positionsRead;
-
-	turnStringLowercase(flag);
+	return makeBooleanAssignmentReturn(isHitDefAttributeMatching(compileHitDefAttributeString(test), getHitDataAttributeFlags(tPlayer)));
+}
 
-	int isFlag1OK;
-	DreamMugenStateType type = getHitDataType(tPlayer);
+static AssignmentReturnValue* evaluateCompiledHitDefAttributeAssignment(AssignmentReturnValue* tValue, DreamPlayer* tPlayer, int* tIsStatic) {
 	*tIsStatic = 0;
-
-	if (type == MUGEN_STATE_TYPE_STANDING) {
-		isFlag1OK = strchr(flag, 's') != NULL;
-	}
-	else if (type == MUGEN_STATE_TYPE_CROUCHING) {
-		isFlag1OK = strchr(flag, 'c') != NULL;
-	}
-	else if (type == MUGEN_STATE_TYPE_AIR) {
-		isFlag1OK = strchr(flag, 'a') != NULL;
-	}
-	else {
-		logWarningFormat("Invalid hitdef type %d. Default to false.", type);
-		isFlag1OK = 0;
-	}
-
-	if (!isFlag1OK) return makeBooleanAssignmentReturn(0);
-
-	if (items == 1) return makeBooleanAssignmentReturn(isFlag1OK);
-	if (strcmp(",", comma)) {
-		logWarningFormat("Invalid hitdef attribute string %s. Defaulting to bottom.", tValue.mValue);
-		return makeBottomAssignmentReturn(); 
-	}
-
-	int hasNext = 1;
-	while (hasNext) {
-		items = sscanf(pos, "%s %s%n", flag, comma, &positionsRead);
-		if (items < 1) {
-			logWarningFormat("Error reading next flag %s. Defaulting to bottom.", pos);
-			return makeBottomAssignmentReturn();
-		}
-		pos += positionsRead;
-
-
-		int isFlag2OK = evaluateSingleHitDefAttributeFlag2(flag, getHitDataAttackClass(tPlayer), getHitDataAttackType(tPlayer));
-		if (isFlag2OK) {
-			return makeBooleanAssignmentReturn(1);
-		}
-
-		if (items == 1) hasNext = 0;
-		else if (strcmp(",", comma)) {
-			logWarningFormat("Invalid hitdef attribute string %s. Defaulting to bottom.", tValue.mValue);
-			return makeBottomAssignmentReturn(); 
-		}
+	if (!isHitDataActive(tPlayer)) {
+		destroyAssignmentReturn(tValue);
+		return makeBooleanAssignmentReturn(0);
 	}
 
-	return makeBooleanAssignmentReturn(0);
+	const auto attributeFlags = uint32_t(convertAssignmentReturnToNumber(tValue));
+	return makeBooleanAssignmentReturn(isHitDefAttributeMatching(attributeFlags, getHitDataAttributeFlags(tPlayer)));
 }
 
 static AssignmentReturnValue* evaluateProjVectorAssignment(AssignmentReturnValue* tCommand, DreamPlayer* tPlayer, int tProjectileID, int(*tTimeFunc)(DreamPlayer*, int), int* tIsStatic) {
@@ -1723,6 +1633,7 @@ static AssignmentReturnValue* animElemComparisonFunction(AssignmentReturnValue*
 static AssignmentReturnValue* timeModComparisonFunction(AssignmentReturnValue* b, DreamPlayer* tPlayer, int* tIsStatic) { return evaluateTimeModAssignment(b, tPlayer, tIsStatic); }
 static AssignmentReturnValue* teamModeComparisonFunction(AssignmentReturnValue* b, DreamPlayer* tPlayer, int* tIsStatic) { return evaluateTeamModeAssignment(b, tPlayer, tIsStatic); }
 static AssignmentReturnValue* hitDefAttributeComparisonFunction(AssignmentReturnValue* b, DreamPlayer* tPlayer, int* tIsStatic) { return evaluateHitDefAttributeAssignment(b, tPlayer, tIsStatic); }
+static AssignmentReturnValue* compiledHitDefAttributeComparisonFunction(AssignmentReturnValue* b, DreamPlayer* tPlayer, int* tIsStatic) { return evaluateCompiledHitDefAttributeAssignment(b, tPlayer, tIsStatic); }
 
 
 static AssignmentReturnValue* animElemOrdinalFunction(AssignmentReturnValue* b, DreamPlayer* tPlayer, int* tIsStatic, int(*tCompareFunction)(int, int)) { return evaluateAnimElemOrdinalAssignment(b, tPlayer, tIsStatic, tCompareFunction); }
@@ -1739,6 +1650,7 @@ static void setupComparisons() {
 	gVariableHandler.mComparisons["timemod"] = timeModComparisonFunction;
 	gVariableHandler.mComparisons["teammode"] = teamModeComparisonFunction;
 	gVariableHandler.mComparisons["hitdefattr"] = hitDefAttributeComparisonFunction;
+	gVariableHandler.mComparisons[MUGEN_COMPILED_HIT_DEF_ATTRIBUTE_VARIABLE_NAME] = compiledHitDefAttributeComparisonFunction;
 
 	gVariableHandler.mOrdinals.clear();
 	gVariableHandler.mOrdinals["animelem"] = animElemOrdinalFunction;
@@ -1,5 +1,10 @@
 #include "mugenbackgroundstatehandler.h"
 
+#include <algorithm>
+#include <climits>
+#include <queue>
+#include <vector>
+
 #include <prism/log.h>
 #include <prism/math.h>
 
@@ -48,6 +53,7 @@ typedef struct {
 	int mStartTime;
 	int mEndTime;
 	int mLoopTime;
+	int mActiveUntil; // in group time, set when the timeline activates the state
 
 	BackgroundControllerType mType;
 	BackgroundDummyController mController;
@@ -60,20 +66,29 @@ typedef struct {
 
 	Vector mElements;
 	Vector mStates;
+	int mTimelineIndex;
 } BackgroundStateGroup;
 
 typedef struct {
 	Vector mBackgroundStateGroups;
 } BackgroundStates;
 
+typedef std::pair<int, int> BackgroundStateActivation; // group time, state index
+
+typedef struct {
+	std::priority_queue<BackgroundStateActivation, std::vector<BackgroundStateActivation>, std::greater<BackgroundStateActivation>> mActivations;
+	std::vector<int> mActiveStates; // sorted by state index, so controllers keep their script order
+} BackgroundStateGroupTimeline;
+
 static struct {
 	BackgroundStates mStates;
-
+	std::vector<BackgroundStateGroupTimeline> mTimelines;
 } gMugenBackgroundStateHandlerData;
 
 static void loadBackgroundStateHandler(void* /*tData*/) {
 	setProfilingSectionMarkerCurrentFunction();
 	gMugenBackgroundStateHandlerData.mStates.mBackgroundStateGroups = new_vector();
+	gMugenBackgroundStateHandlerData.mTimelines.clear();
 }
 
 static void handleNullController() {}
@@ -201,32 +216,81 @@ static void handleSingleBackgroundControllerForOneElement(void* tCaller, void* t
 	}
 }
 
-static void updateSingleBackgroundController(void* tCaller, void* tData) {
-	(void)tCaller;
-	BackgroundStateGroup* group = (BackgroundStateGroup*)tCaller;
-	BackgroundState* e = (BackgroundState*)tData;
+static int getBackgroundStateLocalTime(BackgroundState* e, int tGroupTime) {
+	if (e->mLoopTime <= 0) return tGroupTime;
+	return tGroupTime % e->mLoopTime;
+}
+
+static int getBackgroundStateWindowStart(BackgroundState* e) {
+	return std::max(0, e->mStartTime);
+}
 
-	if (group->mLoopTime != -1 && group->mTime == group->mLoopTime) e->mTime = 0;
-	if (e->mLoopTime != -1 && e->mTime == e->mLoopTime) e->mTime = 0;
+static int getBackgroundStateWindowEnd(BackgroundState* e) {
+	if (e->mLoopTime <= 0) return e->mEndTime;
+	return std::min(e->mEndTime, e->mLoopTime - 1);
+}
 
+static void rebuildBackgroundStateGroupTimeline(BackgroundStateGroup* tGroup) {
+	auto& timeline = gMugenBackgroundStateHandlerData.mTimelines[tGroup->mTimelineIndex];
+	timeline.mActivations = decltype(timeline.mActivations)();
+	timeline.mActiveStates.clear();
+
+	const auto stateAmount = vector_size(&tGroup->mStates);
+	for (int i = 0; i < stateAmount; i++) {
+		BackgroundState* e = (BackgroundState*)vector_get(&tGroup->mStates, i);
+		const auto windowStart = getBackgroundStateWindowStart(e);
+		if (getBackgroundStateWindowEnd(e) < windowStart) continue;
+		timeline.mActivations.push(std::make_pair(windowStart, i));
+	}
+}
 
-	if (e->mTime >= e->mStartTime && e->mTime <= e->mEndTime) {
+static void activateScheduledBackgroundStates(BackgroundStateGroup* tGroup) {
+	auto& timeline = gMugenBackgroundStateHandlerData.mTimelines[tGroup->mTimelineIndex];
+	while (!timeline.mActivations.empty() && timeline.mActivations.top().first <= tGroup->mTime) {
+		const auto index = timeline.mActivations.top().second;
+		timeline.mActivations.pop();
+
+		BackgroundState* e = (BackgroundState*)vector_get(&tGroup->mStates, index);
+		const auto localTime = getBackgroundStateLocalTime(e, tGroup->mTime);
+		const auto activeUntil = (long long)tGroup->mTime + getBackgroundStateWindowEnd(e) - localTime;
+		e->mActiveUntil = int(std::min(activeUntil, (long long)INT_MAX));
+		if (e->mLoopTime > 0) {
+			timeline.mActivations.push(std::make_pair(tGroup->mTime - localTime + e->mLoopTime + getBackgroundStateWindowStart(e), index));
+		}
+
+		const auto it = std::lower_bound(timeline.mActiveStates.begin(), timeline.mActiveStates.end(), index);
+		if (it == timeline.mActiveStates.end() || *it != index) {
+			timeline.mActiveStates.insert(it, index);
+		}
+	}
+}
+
+static void updateActiveBackgroundStates(BackgroundStateGroup* tGroup) {
+	auto& activeStates = gMugenBackgroundStateHandlerData.mTimelines[tGroup->mTimelineIndex].mActiveStates;
+	auto writeIt = activeStates.begin();
+	for (const auto index : activeStates) {
+		BackgroundState* e = (BackgroundState*)vector_get(&tGroup->mStates, index);
+		if (e->mActiveUntil < tGroup->mTime) continue;
+		*writeIt++ = index;
+
+		e->mTime = getBackgroundStateLocalTime(e, tGroup->mTime);
 		Vector* elements;
 		if (vector_size(&e->mElements)) elements = &e->mElements;
-		else elements = &group->mElements;
-	
+		else elements = &tGroup->mElements;
+
 		vector_map(elements, handleSingleBackgroundControllerForOneElement, e);
 	}
-
-	e->mTime++;
+	activeStates.erase(writeIt, activeStates.end());
 }
 
 static void updateSingleBackgroundGroup(void* tCaller, void* tData) {
 	(void)tCaller;
 	BackgroundStateGroup* group = (BackgroundStateGroup*)tData;
-	vector_map(&group->mStates, updateSingleBackgroundController, group);
-
 	if (group->mLoopTime != -1 && group->mTime == group->mLoopTime) group->mTime = 0;
+	if (!group->mTime) rebuildBackgroundStateGroupTimeline(group);
+
+	activateScheduledBackgroundStates(group);
+	updateActiveBackgroundStates(group);
 	group->mTime++;
 }
 
@@ -370,6 +434,7 @@ static void loadBackgroundStateController(MugenDefScriptGroup* tGroup) {
 	e->mEndTime = timeVector.y;
 	e->mLoopTime = timeVector.z;
 	e->mTime = 0;
+	e->mActiveUntil = -1;
 
 	loadControllerType(e, tGroup);
 
@@ -382,6 +447,8 @@ static void loadBackgroundStateControllerDef(MugenDefScriptGroup* tGroup) {
 	group->mLoopTime = getMugenDefIntegerOrDefaultAsGroup(tGroup, "looptime", -1);
 	group->mStates = new_vector();
 	group->mTime = 0;
+	group->mTimelineIndex = int(gMugenBackgroundStateHandlerData.mTimelines.size());
+	gMugenBackgroundStateHandlerData.mTimelines.push_back(BackgroundStateGroupTimeline());
 	vector_push_back_owned(&gMugenBackgroundStateHandlerData.mStates.mBackgroundStateGroups, group);
 }
 
@@ -14,6 +14,7 @@
 
 #include "gamelogic.h"
 #include "fightnetplay.h"
+#include "fightreplay.h"
 
 using namespace std;
 
@@ -643,11 +644,30 @@ static void updateInputMask(int i) {
 	}
 }
 
+static void updateInputMasksFromReplay() {
+	uint32_t masks[2];
+	popFightReplayInputMasks(&masks[0], &masks[1]);
+	for (int i = 0; i < 2; i++) {
+		gMugenCommandHandler.mPreviousHeldMask[i] = gMugenCommandHandler.mHeldMask[i];
+		gMugenCommandHandler.mHeldMask[i] = masks[i];
+		gMugenCommandHandler.mOverrideMask[i] = 0;
+	}
+}
+
 static void updateInputMasks() {
+	if (isFightReplayPlaying()) {
+		updateInputMasksFromReplay();
+		return;
+	}
+
 	int i;
 	for (i = 0; i < 2; i++) {
 		updateInputMask(i);
 	}
+
+	if (isFightReplayRecording()) {
+		recordFightReplayInputMasks(gMugenCommandHandler.mHeldMask[0], gMugenCommandHandler.mHeldMask[1]);
+	}
 }
 
 static void updateSingleRegisteredCommand(RegisteredMugenCommand& tData) {
@@ -11,6 +11,8 @@
 #include <prism/mugendefreader.h>
 #include <prism/math.h>
 
+#include "characterpackage.h"
+
 using namespace std;
 
 static struct {
@@ -403,7 +405,7 @@ static DreamMugenCommands makeEmptyMugenCommands() {
 DreamMugenCommands loadDreamMugenCommandFile(char * tPath)
 {
 	MugenDefScript script; 
-	loadMugenDefScript(&script, tPath);
+	loadCharacterMugenDefScript(&script, tPath);
 	DreamMugenCommands ret = makeEmptyMugenCommands();
 
     loadMugenCommandsFromDefScript(&ret, &script);
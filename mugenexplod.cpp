@@ -1,11 +1,15 @@
 #include "mugenexplod.h"
 
+#include <assert.h>
+#include <limits.h>
+#include <set>
+#include <vector>
+
 #include <prism/geometry.h>
 #include <prism/physics.h>
 #include <prism/datastructures.h>
 #include <prism/memoryhandler.h>
 #include <prism/mugenanimationhandler.h>
-#include <prism/physicshandler.h>
 #include <prism/log.h>
 #include <prism/system.h>
 #include <prism/stlutil.h>
@@ -20,12 +24,14 @@
 #include "mugenstatehandler.h"
 
 #define EXPLOD_SHADOW_Z 32
+#define EXPLOD_REMAINING_TIME_INFINITE INT_MAX
 
 using namespace std;
 
 typedef struct {
 	int mInternalID;
 	DreamPlayer* mPlayer;
+	DreamPlayerReference mPlayerReference; // mPlayer may already be the next helper in the owner's store slot
 
 	int mIsInFightDefFile;
 	int mAnimationNumber;
@@ -65,39 +71,182 @@ typedef struct {
 	int mHasTransparencyType;
 	DreamExplodTransparencyType mTransparencyType;
 
-	PhysicsHandlerElement* mPhysicsElement;
+	int mKinematicsIndex;
 	MugenAnimationHandlerElement* mAnimationElement;
 	MugenAnimationHandlerElement* mShadowAnimationElement;
 
-	double mTimeDilatationNow;
-	double mTimeDilatation;
-	int mNow;
+	int mNow; // remove time steps counted before the last remove time change
+
+	uint64_t mCreationIndex;
 } Explod;
 
+typedef struct {
+	int mKinematicsIndex;
+	MugenAnimationHandlerElement* mAnimationElement;
+	MugenAnimationHandlerElement* mShadowAnimationElement;
+} ExplodElements;
+
+
+typedef struct {
+	DreamPlayerReference mOwner;
+	set<int> mExplods; // internal IDs
+	unordered_map<int, set<int>> mExplodsWithID; // external ID -> internal IDs
+} ExplodOwnerIndex;
+
+typedef struct {
+	vector<double> mPositionX;
+	vector<double> mPositionY;
+	vector<double> mVelocityX;
+	vector<double> mVelocityY;
+	vector<double> mAccelerationX;
+	vector<double> mAccelerationY;
+	vector<int> mAcceleratedSteps; // steps this tick that apply acceleration before moving
+	vector<int> mCoastingSteps; // steps this tick after the accelerated ones that only move
+	vector<int> mIsBound;
+	vector<double> mTimeDilatation;
+	vector<double> mTimeDilatationNow; // fraction of the next step already passed, the drawn position is moved along by it
+	vector<int> mRemainingTime; // steps until removal, EXPLOD_REMAINING_TIME_INFINITE while the remove time is negative
+
+	vector<Position> mBasePositions; // referenced by the animation elements, never reallocated while explods are loaded
+	int mSize;
+} ExplodKinematics;
 
 static struct {
 	unordered_map<int, Explod> mExplods;
+	unordered_map<DreamPlayer*, ExplodOwnerIndex> mOwnerIndex;
+
+	vector<ExplodElements> mFreeElements; // hidden and paused, recycled by finalizeExplod
+	ExplodKinematics mKinematics;
+	int mCapacity;
+	uint64_t mCreationCounter;
 } gMugenExplod;
 
+static void resizeExplodKinematics(int tCapacity) {
+	auto& k = gMugenExplod.mKinematics;
+	k.mPositionX.assign(tCapacity, 0.0);
+	k.mPositionY.assign(tCapacity, 0.0);
+	k.mVelocityX.assign(tCapacity, 0.0);
+	k.mVelocityY.assign(tCapacity, 0.0);
+	k.mAccelerationX.assign(tCapacity, 0.0);
+	k.mAccelerationY.assign(tCapacity, 0.0);
+	k.mAcceleratedSteps.assign(tCapacity, 0);
+	k.mCoastingSteps.assign(tCapacity, 0);
+	k.mIsBound.assign(tCapacity, 0);
+	k.mTimeDilatation.assign(tCapacity, 1.0);
+	k.mTimeDilatationNow.assign(tCapacity, 0.0);
+	k.mRemainingTime.assign(tCapacity, EXPLOD_REMAINING_TIME_INFINITE);
+	k.mBasePositions.assign(tCapacity, Vector3D(0, 0, 0));
+	k.mSize = 0;
+}
+
 static void loadExplods(void* tData) {
 	(void)tData;
 	setProfilingSectionMarkerCurrentFunction();
 	gMugenExplod.mExplods.clear();
+	gMugenExplod.mOwnerIndex.clear();
+	gMugenExplod.mCapacity = std::max(1, getConfigExplodMax());
+	gMugenExplod.mFreeElements.clear();
+	gMugenExplod.mFreeElements.reserve(gMugenExplod.mCapacity);
+	resizeExplodKinematics(gMugenExplod.mCapacity);
+	gMugenExplod.mCreationCounter = 0;
 }
 
 static void unloadExplods(void* tData) {
 	(void)tData;
 	setProfilingSectionMarkerCurrentFunction();
 	gMugenExplod.mExplods.clear();
+	gMugenExplod.mOwnerIndex.clear();
+	gMugenExplod.mFreeElements.clear();
+}
+
+static void addExplodToOwnerIndex(Explod* e) {
+	auto& ownerIndex = gMugenExplod.mOwnerIndex[e->mPlayer];
+	if (!isPlayerReferenceTo(ownerIndex.mOwner, e->mPlayer)) { // new, or left behind by the previous helper in the slot
+		ownerIndex.mOwner = e->mPlayerReference;
+		ownerIndex.mExplods.clear();
+		ownerIndex.mExplodsWithID.clear();
+	}
+	ownerIndex.mExplods.insert(e->mInternalID);
+	ownerIndex.mExplodsWithID[e->mExternalID].insert(e->mInternalID);
+}
+
+static void removeExplodFromOwnerIndex(Explod* e) {
+	auto ownerIt = gMugenExplod.mOwnerIndex.find(e->mPlayer);
+	if (ownerIt == gMugenExplod.mOwnerIndex.end()) return;
+	auto& ownerIndex = ownerIt->second;
+
+	ownerIndex.mExplods.erase(e->mInternalID);
+	auto idIt = ownerIndex.mExplodsWithID.find(e->mExternalID);
+	if (idIt != ownerIndex.mExplodsWithID.end()) {
+		idIt->second.erase(e->mInternalID);
+		if (idIt->second.empty()) ownerIndex.mExplodsWithID.erase(idIt);
+	}
+	if (ownerIndex.mExplods.empty()) gMugenExplod.mOwnerIndex.erase(ownerIt);
+}
+
+static const set<int>* getIndexedExplodsForPlayer(DreamPlayer* tPlayer) {
+	const auto ownerIt = gMugenExplod.mOwnerIndex.find(tPlayer);
+	if (ownerIt == gMugenExplod.mOwnerIndex.end() || !isPlayerReferenceTo(ownerIt->second.mOwner, tPlayer)) return NULL;
+	return &ownerIt->second.mExplods;
+}
+
+static const set<int>* getIndexedExplodsForPlayerWithID(DreamPlayer* tPlayer, int tExplodID) {
+	const auto ownerIt = gMugenExplod.mOwnerIndex.find(tPlayer);
+	if (ownerIt == gMugenExplod.mOwnerIndex.end() || !isPlayerReferenceTo(ownerIt->second.mOwner, tPlayer)) return NULL;
+	const auto idIt = ownerIt->second.mExplodsWithID.find(tExplodID);
+	if (idIt == ownerIt->second.mExplodsWithID.end()) return NULL;
+	return &idIt->second;
+}
+
+template<typename T>
+static void mapIndexedExplodsForPlayer(void(*tFunc)(T*, Explod&), T* tCaller) {
+	const auto internalIDs = tCaller->mID == -1 ? getIndexedExplodsForPlayer(tCaller->mPlayer) : getIndexedExplodsForPlayerWithID(tCaller->mPlayer, tCaller->mID);
+	if (!internalIDs) return;
+
+	for (const auto internalID : *internalIDs) {
+		tFunc(tCaller, gMugenExplod.mExplods[internalID]);
+	}
+}
+
+static void unloadExplod(Explod* e);
+
+static int isExplodEvictedBefore(const Explod& tLeft, const Explod& tRight) {
+	if (tLeft.mSpritePriority != tRight.mSpritePriority) return tLeft.mSpritePriority < tRight.mSpritePriority;
+	return tLeft.mCreationIndex < tRight.mCreationIndex;
+}
+
+static int evictExplod() {
+	Explod* evicted = NULL;
+	for (auto& explodPair : gMugenExplod.mExplods) {
+		auto& e = explodPair.second;
+		if (!e.mAnimationElement) continue;
+		if (!evicted || isExplodEvictedBefore(e, *evicted)) evicted = &e;
+	}
+	if (!evicted) return 0;
+
+	const auto internalID = evicted->mInternalID;
+	unloadExplod(evicted);
+	gMugenExplod.mExplods.erase(internalID);
+	return 1;
+}
+
+static void enforceExplodMax() {
+	while (int(gMugenExplod.mExplods.size()) >= gMugenExplod.mCapacity) {
+		if (!evictExplod()) break;
+	}
 }
 
 int addExplod(DreamPlayer* tPlayer)
 {
+	enforceExplodMax();
+
 	int id = stl_int_map_push_back(gMugenExplod.mExplods, Explod());
 	Explod& e = gMugenExplod.mExplods[id];
 	e.mRemoveTime = -2;
 	e.mPlayer = tPlayer;
+	e.mPlayerReference = getPlayerReference(tPlayer);
 	e.mInternalID = id;
+	e.mCreationIndex = gMugenExplod.mCreationCounter++;
 	return e.mInternalID;
 }
 
@@ -404,7 +553,7 @@ static void updateActiveExplodShadow(Explod* e) {
 	if (!isDrawingShadowsConfig()) return;
 
 	const auto stageOffset = getDreamStageCoordinateSystemOffset(getDreamMugenStageHandlerCameraCoordinateP());
-	const auto physicsPosition = getHandledPhysicsPositionReference(e->mPhysicsElement)->y;
+	const auto physicsPosition = gMugenExplod.mKinematics.mPositionY[e->mKinematicsIndex];
 	const auto explodAnimationPosition = getMugenAnimationPosition(e->mAnimationElement);
 	const auto noCameraPosY = physicsPosition + explodAnimationPosition.y;
 	const auto screenPositionY = noCameraPosY - getDreamMugenStageHandlerCameraPositionReference()->y;
@@ -433,6 +582,89 @@ static void updateExplodShadowColorAndVisibility(Explod* e) {
 	}
 }
 
+static void resetRecycledExplodAnimationElement(MugenAnimationHandlerElement* tElement, MugenAnimation* tAnimation, MugenSpriteFile* tSprites, const Position& tPosition) {
+	setMugenAnimationSprites(tElement, tSprites);
+	changeMugenAnimation(tElement, tAnimation);
+	setMugenAnimationPosition(tElement, tPosition);
+	removeMugenAnimationPaletteEffectIfExists(tElement);
+	setMugenAnimationBlendType(tElement, BLEND_TYPE_NORMAL);
+	setMugenAnimationSpeed(tElement, 1.0);
+	unpauseMugenAnimation(tElement);
+}
+
+static int getExplodRemainingTime(Explod* e) {
+	if (e->mRemoveTime < 0) return EXPLOD_REMAINING_TIME_INFINITE;
+	return e->mRemoveTime - e->mNow;
+}
+
+// keeps counting from the steps already passed, like comparing the explod's time against the new remove time
+static void changeExplodRemoveTime(Explod* e, int tRemoveTime) {
+	auto& remainingTime = gMugenExplod.mKinematics.mRemainingTime[e->mKinematicsIndex];
+	if (e->mRemoveTime >= 0) e->mNow = e->mRemoveTime - remainingTime;
+	e->mRemoveTime = tRemoveTime;
+	remainingTime = getExplodRemainingTime(e);
+}
+
+static void resetExplodKinematics(Explod* e) {
+	auto& k = gMugenExplod.mKinematics;
+	const auto i = e->mKinematicsIndex;
+	k.mPositionX[i] = k.mPositionY[i] = 0.0;
+	k.mVelocityX[i] = e->mVelocity.x;
+	k.mVelocityY[i] = e->mVelocity.y;
+	k.mAccelerationX[i] = e->mAcceleration.x;
+	k.mAccelerationY[i] = e->mAcceleration.y;
+	k.mAcceleratedSteps[i] = k.mCoastingSteps[i] = 0;
+	k.mIsBound[i] = 0;
+	k.mTimeDilatation[i] = 1.0;
+	k.mTimeDilatationNow[i] = 0.0;
+	e->mNow = 0;
+	k.mRemainingTime[i] = getExplodRemainingTime(e);
+	k.mBasePositions[i] = Vector3D(0, 0, 0);
+}
+
+static void acquireExplodElements(Explod* e, MugenAnimation* tAnimation, MugenSpriteFile* tSprites, const Position& tPosition) {
+	auto& k = gMugenExplod.mKinematics;
+	if (gMugenExplod.mFreeElements.empty()) {
+		assert(k.mSize < gMugenExplod.mCapacity);
+		e->mKinematicsIndex = k.mSize++;
+		k.mBasePositions[e->mKinematicsIndex] = Vector3D(0, 0, 0);
+		e->mAnimationElement = addMugenAnimation(tAnimation, tSprites, tPosition);
+		e->mShadowAnimationElement = addMugenAnimation(tAnimation, tSprites, Vector3D(0, 0, 0));
+		setMugenAnimationBasePosition(e->mAnimationElement, &k.mBasePositions[e->mKinematicsIndex]);
+		setMugenAnimationBasePosition(e->mShadowAnimationElement, &k.mBasePositions[e->mKinematicsIndex]);
+		resetExplodKinematics(e);
+		return;
+	}
+
+	const auto elements = gMugenExplod.mFreeElements.back();
+	gMugenExplod.mFreeElements.pop_back();
+	e->mKinematicsIndex = elements.mKinematicsIndex;
+	e->mAnimationElement = elements.mAnimationElement;
+	e->mShadowAnimationElement = elements.mShadowAnimationElement;
+	resetExplodKinematics(e);
+
+	resetRecycledExplodAnimationElement(e->mAnimationElement, tAnimation, tSprites, tPosition);
+	resetRecycledExplodAnimationElement(e->mShadowAnimationElement, tAnimation, tSprites, Vector3D(0, 0, 0));
+	setMugenAnimationVisibility(e->mAnimationElement, 1);
+}
+
+static void releaseExplodElements(Explod* e) {
+	// live and free element sets never exceed the capacity together, since new sets are only created when the free list is empty
+	setMugenAnimationCallback(e->mAnimationElement, NULL, NULL);
+	setMugenAnimationVisibility(e->mAnimationElement, 0);
+	setMugenAnimationVisibility(e->mShadowAnimationElement, 0);
+	pauseMugenAnimation(e->mAnimationElement);
+	pauseMugenAnimation(e->mShadowAnimationElement);
+	gMugenExplod.mKinematics.mAcceleratedSteps[e->mKinematicsIndex] = 0;
+	gMugenExplod.mKinematics.mCoastingSteps[e->mKinematicsIndex] = 0;
+
+	ExplodElements elements;
+	elements.mKinematicsIndex = e->mKinematicsIndex;
+	elements.mAnimationElement = e->mAnimationElement;
+	elements.mShadowAnimationElement = e->mShadowAnimationElement;
+	gMugenExplod.mFreeElements.push_back(elements);
+}
+
 void finalizeExplod(int tID)
 {
 	Explod* e = &gMugenExplod.mExplods[tID];
@@ -444,14 +676,9 @@ void finalizeExplod(int tID)
 
 	updateExplodSpaceFinalization(e);
 
-	e->mPhysicsElement = addToPhysicsHandler(Vector3D(0, 0, 0));
-	addAccelerationToHandledPhysics(e->mPhysicsElement, e->mVelocity);
-
 	const auto p = getExplodPosition(e);
-	e->mAnimationElement = addMugenAnimation(animation, sprites, p);
-	e->mShadowAnimationElement = addMugenAnimation(animation, sprites, Vector3D(0, 0, 0));
-	setMugenAnimationBasePosition(e->mAnimationElement, getHandledPhysicsPositionReference(e->mPhysicsElement));
-	setMugenAnimationBasePosition(e->mShadowAnimationElement, getHandledPhysicsPositionReference(e->mPhysicsElement));
+	acquireExplodElements(e, animation, sprites, p);
+
 	setMugenAnimationCallback(e->mAnimationElement, explodAnimationFinishedCB, e);
 	setMugenAnimationFaceDirection(e->mAnimationElement, !e->mIsFlippedHorizontally);
 	setMugenAnimationFaceDirection(e->mShadowAnimationElement, !e->mIsFlippedHorizontally);
@@ -471,9 +698,7 @@ void finalizeExplod(int tID)
 	updateExplodSpaceCamera(e);
 	updateActiveExplodShadow(e);
 
-	e->mTimeDilatationNow = 0.0;
-	e->mTimeDilatation = 1.0;
-	e->mNow = 0;
+	addExplodToOwnerIndex(e);
 }
 
 typedef struct {
@@ -491,9 +716,6 @@ typedef struct {
 static void updateExplodAnimationForSingleExplod(IntegerSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
-
 	e->mIsInFightDefFile = tCaller->mValue.x;
 	e->mAnimationNumber = tCaller->mValue.y;
 
@@ -518,7 +740,7 @@ void updateExplodAnimation(DreamPlayer* tPlayer, int tID, int tIsInFightDefFile,
 	caller.mID = tID;
 	caller.mValue.x = tIsInFightDefFile;
 	caller.mValue.y = tAnimationNumber;
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodAnimationForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodAnimationForSingleExplod, &caller);
 }
 
 static void updateExplodPositionAfterUpdate(Explod* e) {
@@ -527,20 +749,23 @@ static void updateExplodPositionAfterUpdate(Explod* e) {
 	updateActiveExplodShadow(e);
 }
 
+static void syncExplodKinematicsAcceleration(Explod* e) {
+	auto& k = gMugenExplod.mKinematics;
+	k.mAccelerationX[e->mKinematicsIndex] = e->mAcceleration.x;
+	k.mAccelerationY[e->mKinematicsIndex] = e->mAcceleration.y;
+}
+
 static void flipExplodPhysicsHorizontal(Explod* e) {
-	auto physicsObjectReference = getPhysicsFromHandler(e->mPhysicsElement);
-	physicsObjectReference->mVelocity.x *= -1;
-	physicsObjectReference->mAcceleration.x *= -1;
+	gMugenExplod.mKinematics.mVelocityX[e->mKinematicsIndex] *= -1;
 }
 
 static void updateExplodSpaceForSingleExplod(IntegerSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
 	const auto previousIsFlippedHorizontally = e->mIsFlippedHorizontally;
 	e->mSpace = DreamExplodSpace(tCaller->mValue.x);
 	updateExplodSpaceFinalization(e);
+	syncExplodKinematicsAcceleration(e);
 	updateExplodSpaceCamera(e);
 	setMugenAnimationFaceDirection(e->mAnimationElement, !e->mIsFlippedHorizontally);
 	setMugenAnimationFaceDirection(e->mShadowAnimationElement, !e->mIsFlippedHorizontally);
@@ -556,15 +781,12 @@ void updateExplodSpace(DreamPlayer* tPlayer, int tID, DreamExplodSpace tSpace)
 	caller.mPlayer = tPlayer;
 	caller.mID = tID;
 	caller.mValue.x = int(tSpace);
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodSpaceForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodSpaceForSingleExplod, &caller);
 }
 
 static void updateExplodPositionForSingleExplod(IntegerSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
-
 	e->mPosition = Vector2D(tCaller->mValue.x, tCaller->mValue.y);
 	e->mPosition = transformDreamCoordinatesVector2D(e->mPosition, getActiveStateMachineCoordinateP(), getDreamMugenStageHandlerCameraCoordinateP());
 	updateExplodPositionAfterUpdate(e);
@@ -577,15 +799,12 @@ void updateExplodPosition(DreamPlayer* tPlayer, int tID, int tOffsetX, int tOffs
 	caller.mID = tID;
 	caller.mValue.x = tOffsetX;
 	caller.mValue.y = tOffsetY;
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodPositionForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodPositionForSingleExplod, &caller);
 }
 
 static void updateExplodPositionTypeForSingleExplod(IntegerSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
-
 	e->mPositionType = DreamExplodPositionType(tCaller->mValue.x);
 	updateExplodPositionAfterUpdate(e);
 }
@@ -596,17 +815,15 @@ void updateExplodPositionType(DreamPlayer* tPlayer, int tID, DreamExplodPosition
 	caller.mPlayer = tPlayer;
 	caller.mID = tID;
 	caller.mValue.x = int(tType);
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodPositionTypeForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodPositionTypeForSingleExplod, &caller);
 }
 
 static void updateExplodHorizontalFacingForSingleExplod(IntegerSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
-
 	e->mIsFlippedHorizontallyAtStart = e->mIsFlippedHorizontally = tCaller->mValue.x == -1;
 	updateExplodSpaceFinalization(e);
+	syncExplodKinematicsAcceleration(e);
 	setMugenAnimationFaceDirection(e->mAnimationElement, !e->mIsFlippedHorizontally);
 	setMugenAnimationFaceDirection(e->mShadowAnimationElement, !e->mIsFlippedHorizontally);
 }
@@ -617,15 +834,12 @@ void updateExplodHorizontalFacing(DreamPlayer* tPlayer, int tID, int tFacing)
 	caller.mPlayer = tPlayer;
 	caller.mID = tID;
 	caller.mValue.x = tFacing;
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodHorizontalFacingForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodHorizontalFacingForSingleExplod, &caller);
 }
 
 static void updateExplodVerticalFacingForSingleExplod(IntegerSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
-
 	e->mIsFlippedVertically = tCaller->mValue.x == -1;
 	setMugenAnimationVerticalFaceDirection(e->mAnimationElement, !e->mIsFlippedVertically);
 	setMugenAnimationVerticalFaceDirection(e->mShadowAnimationElement, !e->mIsFlippedVertically);
@@ -637,15 +851,12 @@ void updateExplodVerticalFacing(DreamPlayer* tPlayer, int tID, int tFacing)
 	caller.mPlayer = tPlayer;
 	caller.mID = tID;
 	caller.mValue.x = tFacing;
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodVerticalFacingForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodVerticalFacingForSingleExplod, &caller);
 }
 
 static void updateExplodBindTimeForSingleExplod(IntegerSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
-
 	e->mBindNow = 0;
 	e->mBindTime = tCaller->mValue.x;
 }
@@ -656,21 +867,17 @@ void updateExplodBindTime(DreamPlayer* tPlayer, int tID, int tBindTime)
 	caller.mPlayer = tPlayer;
 	caller.mID = tID;
 	caller.mValue.x = tBindTime;
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodBindTimeForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodBindTimeForSingleExplod, &caller);
 }
 
 static void updateExplodVelocityForSingleExplod(FloatSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
-
 	e->mVelocity.x = tCaller->mValue.x;
 	e->mVelocity.y = tCaller->mValue.y;
-	auto vel = getHandledPhysicsVelocityReference(e->mPhysicsElement);
-	vel->x = e->mVelocity.x;
-	vel->y = e->mVelocity.y;
-	*vel = transformDreamCoordinatesVector(*vel, getActiveStateMachineCoordinateP(), getDreamMugenStageHandlerCameraCoordinateP());
+	const auto vel = transformDreamCoordinatesVector(Vector3D(e->mVelocity.x, e->mVelocity.y, 0), getActiveStateMachineCoordinateP(), getDreamMugenStageHandlerCameraCoordinateP());
+	gMugenExplod.mKinematics.mVelocityX[e->mKinematicsIndex] = vel.x;
+	gMugenExplod.mKinematics.mVelocityY[e->mKinematicsIndex] = vel.y;
 }
 
 void updateExplodVelocity(DreamPlayer* tPlayer, int tID, double tX, double tY)
@@ -680,21 +887,14 @@ void updateExplodVelocity(DreamPlayer* tPlayer, int tID, double tX, double tY)
 	caller.mID = tID;
 	caller.mValue.x = tX;
 	caller.mValue.y = tY;
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodVelocityForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodVelocityForSingleExplod, &caller);
 }
 
 static void updateExplodAccelerationForSingleExplod(FloatSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
-
-	e->mAcceleration.x = tCaller->mValue.x;
-	e->mAcceleration.y = tCaller->mValue.y;
-	auto acceleration = getHandledPhysicsAccelerationReference(e->mPhysicsElement);
-	acceleration->x = e->mAcceleration.x;
-	acceleration->y = e->mAcceleration.y;
-	*acceleration = transformDreamCoordinatesVector(*acceleration, getActiveStateMachineCoordinateP(), getDreamMugenStageHandlerCameraCoordinateP());
+	e->mAcceleration = transformDreamCoordinatesVector(Vector3D(tCaller->mValue.x, tCaller->mValue.y, 0), getActiveStateMachineCoordinateP(), getDreamMugenStageHandlerCameraCoordinateP());
+	syncExplodKinematicsAcceleration(e);
 }
 
 void updateExplodAcceleration(DreamPlayer* tPlayer, int tID, double tX, double tY)
@@ -704,15 +904,12 @@ void updateExplodAcceleration(DreamPlayer* tPlayer, int tID, double tX, double t
 	caller.mID = tID;
 	caller.mValue.x = tX;
 	caller.mValue.y = tY;
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodAccelerationForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodAccelerationForSingleExplod, &caller);
 }
 
 static void updateExplodRandomOffsetForSingleExplod(IntegerSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
-
 	e->mRandomOffset = Vector2DI(randfromInteger(getExplodRandomRangeMin(tCaller->mValue.x), getExplodRandomRangeMax(tCaller->mValue.x)), randfromInteger(getExplodRandomRangeMin(tCaller->mValue.y), getExplodRandomRangeMax(tCaller->mValue.y)));
 	e->mRandomOffset = transformDreamCoordinatesVector2DI(e->mRandomOffset, getActiveStateMachineCoordinateP(), getDreamMugenStageHandlerCameraCoordinateP());
 	updateExplodPositionAfterUpdate(e);
@@ -725,16 +922,13 @@ void updateExplodRandomOffset(DreamPlayer* tPlayer, int tID, int tX, int tY)
 	caller.mID = tID;
 	caller.mValue.x = tX;
 	caller.mValue.y = tY;
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodRandomOffsetForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodRandomOffsetForSingleExplod, &caller);
 }
 
 static void updateExplodRemoveTimeForSingleExplod(IntegerSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
-
-	e->mRemoveTime = tCaller->mValue.x;
+	changeExplodRemoveTime(e, tCaller->mValue.x);
 }
 
 void updateExplodRemoveTime(DreamPlayer* tPlayer, int tID, int tRemoveTime)
@@ -743,15 +937,12 @@ void updateExplodRemoveTime(DreamPlayer* tPlayer, int tID, int tRemoveTime)
 	caller.mPlayer = tPlayer;
 	caller.mID = tID;
 	caller.mValue.x = tRemoveTime;
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodRemoveTimeForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodRemoveTimeForSingleExplod, &caller);
 }
 
 static void updateExplodSuperMoveForSingleExplod(IntegerSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
-
 	e->mSuperMoveTime = INF * tCaller->mValue.x;
 }
 
@@ -761,15 +952,12 @@ void updateExplodSuperMove(DreamPlayer* tPlayer, int tID, int tIsSuperMove)
 	caller.mPlayer = tPlayer;
 	caller.mID = tID;
 	caller.mValue.x = tIsSuperMove;
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodSuperMoveForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodSuperMoveForSingleExplod, &caller);
 }
 
 static void updateExplodSuperMoveTimeForSingleExplod(IntegerSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
-
 	e->mSuperMoveTime = tCaller->mValue.x;
 }
 
@@ -779,15 +967,12 @@ void updateExplodSuperMoveTime(DreamPlayer* tPlayer, int tID, int tSuperMoveTime
 	caller.mPlayer = tPlayer;
 	caller.mID = tID;
 	caller.mValue.x = tSuperMoveTime;
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodSuperMoveTimeForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodSuperMoveTimeForSingleExplod, &caller);
 }
 
 static void updateExplodPauseMoveTimeForSingleExplod(IntegerSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
-
 	e->mPauseMoveTime = tCaller->mValue.x;
 }
 
@@ -797,15 +982,12 @@ void updateExplodPauseMoveTime(DreamPlayer* tPlayer, int tID, int tPauseMoveTime
 	caller.mPlayer = tPlayer;
 	caller.mID = tID;
 	caller.mValue.x = tPauseMoveTime;
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodPauseMoveTimeForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodPauseMoveTimeForSingleExplod, &caller);
 }
 
 static void updateExplodScaleForSingleExplod(FloatSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
-
 	e->mScale.x = tCaller->mValue.x;
 	e->mScale.y = tCaller->mValue.y;
 	setMugenAnimationDrawScale(e->mAnimationElement, e->mScale);
@@ -819,15 +1001,12 @@ void updateExplodScale(DreamPlayer* tPlayer, int tID, double tX, double tY)
 	caller.mID = tID;
 	caller.mValue.x = tX;
 	caller.mValue.y = tY;
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodScaleForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodScaleForSingleExplod, &caller);
 }
 
 static void updateExplodSpritePriorityForSingleExplod(IntegerSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
-
 	e->mSpritePriority = tCaller->mValue.x;
 	updateExplodPositionAfterUpdate(e);
 }
@@ -838,15 +1017,12 @@ void updateExplodSpritePriority(DreamPlayer* tPlayer, int tID, int tSpritePriori
 	caller.mPlayer = tPlayer;
 	caller.mID = tID;
 	caller.mValue.x = tSpritePriority;
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodSpritePriorityForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodSpritePriorityForSingleExplod, &caller);
 }
 
 static void updateExplodOnTopForSingleExplod(IntegerSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
-
 	e->mIsOnTop = tCaller->mValue.x;
 	updateExplodPositionAfterUpdate(e);
 }
@@ -857,15 +1033,12 @@ void updateExplodOnTop(DreamPlayer* tPlayer, int tID, int tIsOnTop)
 	caller.mPlayer = tPlayer;
 	caller.mID = tID;
 	caller.mValue.x = tIsOnTop;
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodOnTopForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodOnTopForSingleExplod, &caller);
 }
 
 static void updateExplodShadowForSingleExplod(IntegerSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
-
 	parseShadowStatus(e, tCaller->mValue.x, tCaller->mValue.y, tCaller->mValue.z);
 	updateExplodShadowColorAndVisibility(e);
 	updateActiveExplodShadow(e);
@@ -877,15 +1050,12 @@ void updateExplodShadow(DreamPlayer* tPlayer, int tID, int tR, int tG, int tB)
 	caller.mPlayer = tPlayer;
 	caller.mID = tID;
 	caller.mValue = Vector3DI(tR, tG, tB);
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodShadowForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodShadowForSingleExplod, &caller);
 }
 
 static void updateExplodOwnPaletteForSingleExplod(IntegerSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
-
 	e->mUsesOwnPalette = tCaller->mValue.x;
 }
 
@@ -895,15 +1065,12 @@ void updateExplodOwnPalette(DreamPlayer* tPlayer, int tID, int tUsesOwnPalette)
 	caller.mPlayer = tPlayer;
 	caller.mID = tID;
 	caller.mValue.x = tUsesOwnPalette;
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodOwnPaletteForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodOwnPaletteForSingleExplod, &caller);
 }
 
 static void updateExplodRemoveOnGetHitForSingleExplod(IntegerSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
-
 	e->mIsRemovedOnGetHit = tCaller->mValue.x;
 }
 
@@ -913,15 +1080,12 @@ void updateExplodRemoveOnGetHit(DreamPlayer* tPlayer, int tID, int tIsRemovedOnG
 	caller.mPlayer = tPlayer;
 	caller.mID = tID;
 	caller.mValue.x = tIsRemovedOnGetHit;
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodRemoveOnGetHitForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodRemoveOnGetHitForSingleExplod, &caller);
 }
 
 static void updateExplodIgnoreHitPauseForSingleExplod(IntegerSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
-
 	e->mIgnoreHitPause = tCaller->mValue.x;
 }
 
@@ -931,15 +1095,12 @@ void updateExplodIgnoreHitPause(DreamPlayer* tPlayer, int tID, int tIgnoreHitPau
 	caller.mPlayer = tPlayer;
 	caller.mID = tID;
 	caller.mValue.x = tIgnoreHitPause;
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodIgnoreHitPauseForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodIgnoreHitPauseForSingleExplod, &caller);
 }
 
 static void updateExplodTransparencyForSingleExplod(IntegerSetterForIDCaller* tCaller, Explod& tData) {
 	Explod* e = &tData;
 
-	if (e->mPlayer != tCaller->mPlayer) return;
-	if (tCaller->mID != -1 && e->mExternalID != tCaller->mID) return;
-
 	e->mHasTransparencyType = 1;
 	e->mTransparencyType = DreamExplodTransparencyType(tCaller->mValue.x);
 	setMugenAnimationBlendType(e->mAnimationElement, e->mTransparencyType == EXPLOD_TRANSPARENCY_TYPE_ADD_ALPHA ? BLEND_TYPE_ADDITION : BLEND_TYPE_NORMAL);
@@ -951,77 +1112,40 @@ void updateExplodTransparencyType(DreamPlayer* tPlayer, int tID, DreamExplodTran
 	caller.mPlayer = tPlayer;
 	caller.mID = tID;
 	caller.mValue.x = int(tTransparencyType);
-	stl_int_map_map(gMugenExplod.mExplods, updateExplodTransparencyForSingleExplod, &caller);
+	mapIndexedExplodsForPlayer(updateExplodTransparencyForSingleExplod, &caller);
 }
 
 static void unloadExplod(Explod* e) {
-	removeMugenAnimation(e->mAnimationElement);
-	removeMugenAnimation(e->mShadowAnimationElement);
-	removeFromPhysicsHandler(e->mPhysicsElement);
+	removeExplodFromOwnerIndex(e);
+	releaseExplodElements(e);
 }
 
-typedef struct {
-	DreamPlayer* mPlayer;
-	int mExplodID;
-
-} RemoveExplodsCaller;
-
+static void removeIndexedExplods(const set<int>* tInternalIDs, int tOnlyRemovedOnGetHit) {
+	if (!tInternalIDs) return;
 
-static int removeSingleExplodWithID(RemoveExplodsCaller* tCaller, Explod& tData) {
-	Explod* e = &tData;
-
-	if (e->mPlayer == tCaller->mPlayer && e->mExternalID == tCaller->mExplodID) {
-		unloadExplod(e);
-		return 1;
+	const auto internalIDs = *tInternalIDs;
+	for (const auto internalID : internalIDs) {
+		auto& e = gMugenExplod.mExplods[internalID];
+		if (tOnlyRemovedOnGetHit && !e.mIsRemovedOnGetHit) continue;
+		unloadExplod(&e);
+		gMugenExplod.mExplods.erase(internalID);
 	}
-
-	return 0;
 }
 
 void removeExplodsWithID(DreamPlayer* tPlayer, int tExplodID)
 {
-	RemoveExplodsCaller caller;
-	caller.mPlayer = tPlayer;
-	caller.mExplodID = tExplodID;
-	stl_int_map_remove_predicate(gMugenExplod.mExplods, removeSingleExplodWithID, &caller);
-}
-
-static int removeSingleExplod(RemoveExplodsCaller* tCaller, Explod& tData) {
-	Explod* e = &tData;
-
-	if (e->mPlayer == tCaller->mPlayer) {
-		unloadExplod(e);
-		return 1;
-	}
-
-	return 0;
+	removeIndexedExplods(getIndexedExplodsForPlayerWithID(tPlayer, tExplodID), 0);
 }
 
 void removeAllExplodsForPlayer(DreamPlayer* tPlayer)
 {
-	RemoveExplodsCaller caller;
-	caller.mPlayer = tPlayer;
-	stl_int_map_remove_predicate(gMugenExplod.mExplods, removeSingleExplod, &caller);
-}
-
-static int removeSingleExplodAfterHit(RemoveExplodsCaller* tCaller, Explod& tData) {
-	setProfilingSectionMarkerCurrentFunction();
-	Explod* e = &tData;
-
-	if (e->mPlayer == tCaller->mPlayer && e->mIsRemovedOnGetHit) {
-		unloadExplod(e);
-		return 1;
-	}
-
-	return 0;
+	removeIndexedExplods(getIndexedExplodsForPlayer(tPlayer), 0);
 }
 
 void removeExplodsForPlayerAfterHit(DreamPlayer* tPlayer)
 {
 	setProfilingSectionMarkerCurrentFunction();
-	RemoveExplodsCaller caller;
-	caller.mPlayer = tPlayer;
-	stl_int_map_remove_predicate(gMugenExplod.mExplods, removeSingleExplodAfterHit, &caller);
+	removeIndexedExplods(getIndexedExplodsForPlayer(tPlayer), 1);
 }
 
 static int removeSingleExplodAlways(void* /*tCaller*/, Explod& tData) {
@@ -1036,80 +1160,37 @@ void removeAllExplods()
 	stl_int_map_remove_predicate(gMugenExplod.mExplods, removeSingleExplodAlways);
 }
 
-typedef struct {
-	DreamPlayer* mPlayer;
-	int mExplodID;
-	int mReturnValue;
-} FindExplodCaller;
-
-void compareSingleExplodIDToSearchID(FindExplodCaller* tCaller, Explod& tData) {
-	Explod* e = &tData;
-
-	if (e->mPlayer == tCaller->mPlayer && e->mExternalID == tCaller->mExplodID) {
-		tCaller->mReturnValue = e->mInternalID;
-	}
-}
-
 int getExplodIndexFromExplodID(DreamPlayer* tPlayer, int tExplodID)
 {
-	FindExplodCaller caller;
-	caller.mPlayer = tPlayer;
-	caller.mExplodID = tExplodID;
-	caller.mReturnValue = -1;
-
-	stl_int_map_map(gMugenExplod.mExplods, compareSingleExplodIDToSearchID, &caller);
+	const auto internalIDs = getIndexedExplodsForPlayerWithID(tPlayer, tExplodID);
+	if (!internalIDs) return -1;
 
-	return caller.mReturnValue;
+	return *internalIDs->rbegin();
 }
 
 void setPlayerExplodPaletteEffects(DreamPlayer* tPlayer, int tDuration, const Vector3D& tAddition, const Vector3D& tMultiplier, const Vector3D& tSineAmplitude, int tSinePeriod, int tInvertAll, double tColorFactor, int tIgnoreOwnPal)
 {
-	for (auto& explodKeyValuePair : gMugenExplod.mExplods) {
-		auto& explod = explodKeyValuePair.second;
-		if (explod.mPlayer != tPlayer) continue;
+	const auto internalIDs = getIndexedExplodsForPlayer(tPlayer);
+	if (!internalIDs) return;
+
+	for (const auto internalID : *internalIDs) {
+		auto& explod = gMugenExplod.mExplods[internalID];
 		if (!tIgnoreOwnPal && explod.mUsesOwnPalette) continue;
 
 		setMugenAnimationPaletteEffectForDuration(explod.mAnimationElement, tDuration, tAddition, tMultiplier, tSineAmplitude, tSinePeriod, tInvertAll, tColorFactor);
 	}
 }
 
-void compareSingleAmountSearchPlayer(FindExplodCaller* tCaller, Explod& tData) {
-	Explod* e = &tData;
-
-	if (e->mPlayer == tCaller->mPlayer) {
-		tCaller->mReturnValue++;
-	}
-}
-
 int getExplodAmount(DreamPlayer* tPlayer)
 {
-	FindExplodCaller caller;
-	caller.mPlayer = tPlayer;
-	caller.mReturnValue = 0;
-
-	stl_int_map_map(gMugenExplod.mExplods, compareSingleAmountSearchPlayer, &caller);
-
-	return caller.mReturnValue;
-}
-
-void compareSingleAmountSearchExplodIDToSearchID(FindExplodCaller* tCaller, Explod& tData) {
-	Explod* e = &tData;
-
-	if (e->mPlayer == tCaller->mPlayer && e->mExternalID == tCaller->mExplodID) {
-		tCaller->mReturnValue++;
-	}
+	const auto internalIDs = getIndexedExplodsForPlayer(tPlayer);
+	return internalIDs ? int(internalIDs->size()) : 0;
 }
 
 int getExplodAmountWithID(DreamPlayer* tPlayer, int tID)
 {
-	FindExplodCaller caller;
-	caller.mPlayer = tPlayer;
-	caller.mExplodID = tID;
-	caller.mReturnValue = 0;
-
-	stl_int_map_map(gMugenExplod.mExplods, compareSingleAmountSearchExplodIDToSearchID, &caller);
-
-	return caller.mReturnValue;
+	const auto internalIDs = getIndexedExplodsForPlayerWithID(tPlayer, tID);
+	return internalIDs ? int(internalIDs->size()) : 0;
 }
 
 typedef struct {
@@ -1117,10 +1198,9 @@ typedef struct {
 } SetExplodsSpeedCaller;
 
 static void setSingleExplodSpeed(Explod* e, double tSpeed) {
-	e->mTimeDilatation = tSpeed;
+	gMugenExplod.mKinematics.mTimeDilatation[e->mKinematicsIndex] = tSpeed;
 	setMugenAnimationSpeed(e->mAnimationElement, tSpeed);
 	setMugenAnimationSpeed(e->mShadowAnimationElement, tSpeed);
-	setHandledPhysicsSpeed(e->mPhysicsElement, tSpeed);
 }
 
 static void setSingleExplodSpeedCB(SetExplodsSpeedCaller* tSpeedSetCaller, Explod& e) {
@@ -1145,34 +1225,43 @@ static void explodAnimationFinishedCB(void* tCaller) {
 	Explod* e = (Explod*)tCaller;
 	if (e->mRemoveTime != -2) return;
 
-	e->mRemoveTime = 0;
+	changeExplodRemoveTime(e, 0);
 }
 
 static void updateActiveExplodBindTime(Explod* e) {
 	if (e->mBindTime == -1 || e->mBindNow < e->mBindTime) {
 		e->mBindNow++;
-		pauseHandledPhysics(e->mPhysicsElement);
-		if (!isPlayer(e->mPlayer)) {
+		gMugenExplod.mKinematics.mIsBound[e->mKinematicsIndex] = 1;
+		if (!isPlayer(getReferencedPlayer(e->mPlayerReference))) {
 			return;
 		}
 		const auto pos = getExplodPosition(e);
 		setMugenAnimationPosition(e->mAnimationElement, pos);
 	}
 	else {
-		resumeHandledPhysics(e->mPhysicsElement);
+		gMugenExplod.mKinematics.mIsBound[e->mKinematicsIndex] = 0;
 	}
 }
 
 
 static int updateActiveExplodRemoveTime(Explod* e) {
-	if (e->mRemoveTime < 0) return 0;
+	auto& remainingTime = gMugenExplod.mKinematics.mRemainingTime[e->mKinematicsIndex];
+	if (remainingTime == EXPLOD_REMAINING_TIME_INFINITE) return 0;
 
-	e->mNow++;
-	return e->mNow >= e->mRemoveTime;
+	remainingTime--;
+	return remainingTime <= 0;
 }
 
 static void updateActiveExplodPhysics(Explod* e) {
-	addAccelerationToHandledPhysics(e->mPhysicsElement, e->mAcceleration);
+	auto& k = gMugenExplod.mKinematics;
+	if (k.mIsBound[e->mKinematicsIndex]) return;
+	k.mAcceleratedSteps[e->mKinematicsIndex]++;
+}
+
+static void updateActiveExplodPhysicsDuringHitPause(Explod* e, int tRemainingSteps) {
+	auto& k = gMugenExplod.mKinematics;
+	if (k.mIsBound[e->mKinematicsIndex]) return;
+	k.mCoastingSteps[e->mKinematicsIndex] += tRemainingSteps;
 }
 
 static void updateStaticExplodPosition(Explod* e) {
@@ -1213,13 +1302,22 @@ static int updateActiveExplodPauseStopAndReturnIfStopped(Explod* e) {
 static int updateSingleExplod(void* tCaller, Explod& tData) {
 	(void)tCaller;
 	Explod* e = &tData;
+	if (!getReferencedPlayer(e->mPlayerReference)) {
+		unloadExplod(e);
+		return 1;
+	}
 
-	e->mTimeDilatationNow += e->mTimeDilatation;
-	int updateAmount = (int)e->mTimeDilatationNow;
-	e->mTimeDilatationNow -= updateAmount;
+	auto& k = gMugenExplod.mKinematics;
+	auto& timeDilatationNow = k.mTimeDilatationNow[e->mKinematicsIndex];
+	timeDilatationNow += k.mTimeDilatation[e->mKinematicsIndex];
+	int updateAmount = (int)timeDilatationNow;
+	timeDilatationNow -= updateAmount;
 	while (updateAmount--) {
 		updateStaticExplodPosition(e);
-		if (isPlayerHitPaused(e->mPlayer)) return 0;
+		if (isPlayerHitPaused(e->mPlayer)) {
+			updateActiveExplodPhysicsDuringHitPause(e, updateAmount + 1);
+			return 0;
+		}
 
 		if (updateActiveExplodSuperPauseStopAndReturnIfStopped(e)) return 0;
 		if (updateActiveExplodPauseStopAndReturnIfStopped(e)) return 0;
@@ -1230,14 +1328,62 @@ static int updateSingleExplod(void* tCaller, Explod& tData) {
 		}
 
 		updateActiveExplodPhysics(e);
-		updateActiveExplodShadow(e);
 	}
 	return 0;
 }
 
+void advanceExplodMotion(double* ioPosition, double* ioVelocity, double tAcceleration, int tAcceleratedSteps, int tCoastingSteps)
+{
+	// closed form of stepping velocity += acceleration, position += velocity for the accelerated steps, then position += velocity for the coasting steps
+	const double accelerated = tAcceleratedSteps;
+	const double coasting = tCoastingSteps;
+	const double accumulatedAcceleration = accelerated * (accelerated + 1) * 0.5;
+	*ioPosition += *ioVelocity * (accelerated + coasting) + tAcceleration * (accumulatedAcceleration + accelerated * coasting);
+	*ioVelocity += tAcceleration * accelerated;
+}
+
+double getExplodMotionDrawPosition(double tPosition, double tVelocity, double tAcceleration, double tStepFraction)
+{
+	return tPosition + (tVelocity + tAcceleration) * tStepFraction; // along the way to the next accelerated step
+}
+
+static void integrateExplodKinematics() {
+	setProfilingSectionMarkerCurrentFunction();
+	auto& k = gMugenExplod.mKinematics;
+	const auto n = k.mSize;
+	double* positionX = k.mPositionX.data();
+	double* positionY = k.mPositionY.data();
+	double* velocityX = k.mVelocityX.data();
+	double* velocityY = k.mVelocityY.data();
+	const double* accelerationX = k.mAccelerationX.data();
+	const double* accelerationY = k.mAccelerationY.data();
+	int* acceleratedSteps = k.mAcceleratedSteps.data();
+	int* coastingSteps = k.mCoastingSteps.data();
+	const int* isBound = k.mIsBound.data();
+	const double* timeDilatationNow = k.mTimeDilatationNow.data();
+
+	for (int i = 0; i < n; i++) {
+		advanceExplodMotion(&positionX[i], &velocityX[i], accelerationX[i], acceleratedSteps[i], coastingSteps[i]);
+		advanceExplodMotion(&positionY[i], &velocityY[i], accelerationY[i], acceleratedSteps[i], coastingSteps[i]);
+		acceleratedSteps[i] = 0;
+		coastingSteps[i] = 0;
+	}
+
+	// slowed down explods move along inside the step they are in, bound ones stay where their binding put them
+	for (int i = 0; i < n; i++) {
+		const auto stepFraction = isBound[i] ? 0.0 : timeDilatationNow[i];
+		k.mBasePositions[i].x = getExplodMotionDrawPosition(positionX[i], velocityX[i], accelerationX[i], stepFraction);
+		k.mBasePositions[i].y = getExplodMotionDrawPosition(positionY[i], velocityY[i], accelerationY[i], stepFraction);
+	}
+}
+
 static void updateExplods(void* /*tData*/) {
 	setProfilingSectionMarkerCurrentFunction();
 	stl_int_map_remove_predicate(gMugenExplod.mExplods, updateSingleExplod);
+	integrateExplodKinematics();
+	for (auto& explodPair : gMugenExplod.mExplods) {
+		updateActiveExplodShadow(&explodPair.second);
+	}
 }
 
 ActorBlueprint getDreamExplodHandler() {
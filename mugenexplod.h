@@ -87,6 +87,9 @@ void setPlayerExplodPaletteEffects(DreamPlayer* tPlayer, int tDuration, const Ve
 int getExplodAmount(DreamPlayer* tPlayer);
 int getExplodAmountWithID(DreamPlayer* tPlayer, int tID);
 
+void advanceExplodMotion(double* ioPosition, double* ioVelocity, double tAcceleration, int tAcceleratedSteps, int tCoastingSteps);
+double getExplodMotionDrawPosition(double tPosition, double tVelocity, double tAcceleration, double tStepFraction);
+
 void setExplodsSpeed(double tSpeed);
 void setAllExplodsNoShadow();
 
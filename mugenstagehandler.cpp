@@ -11,6 +11,8 @@
 
 using namespace std;
 
+#define STAGE_ELEMENT_CULLING_MARGIN_FACTOR 0.25
+
 typedef struct {
 	vector<StaticStageHandlerElement*> mVector;
 } StageElementIDList;
@@ -83,10 +85,6 @@ static void unloadMugenStageHandler(void* tData = NULL) {
 	gMugenStageHandlerData.mStageElementsFromID.clear();
 }
 
-typedef struct{
-	StaticStageHandlerElement* e;
-} updateStageTileCaller;
-
 static int getTileAmountSingleAxis(int tSize, int tScreenSize, double tDelta, double tInvertedMinimumWidthFactor) {
 	const auto length = (int)(((2 * tScreenSize) + (tSize * tInvertedMinimumWidthFactor)) * (1 / tDelta));
 	return int(length / (tSize * (1.0 / tInvertedMinimumWidthFactor)) + 1);
@@ -100,69 +98,116 @@ static Vector2DI getTileAmount(StaticStageHandlerElement* e) {
 	return Vector2DI(x, y);
 }
 
-static void updateSingleStaticStageElementTileTiling(StaticStageHandlerElement* e, StageElementAnimationReference* tSingleAnimation, const Vector2D& tTotalScale) {
-	const auto amount = getTileAmount(e);
-	auto offset = getAnimationFirstElementSpriteOffset(e->mAnimation, e->mSprites);
+typedef struct{
+	StaticStageHandlerElement* e;
+
+	int mIsVisible;
+	Vector2D mTotalScale;
+	int mIsTotalScaleChanged;
+	Position mParallaxBottomBasePosition;
+	int mHasMultipleTiles;
+
+	Vector2DI mTileAmount;
+	Vector2DI mSpriteOffset;
+	Vector2DI mTotalTileSize;
+	Vector2D mScreenSize;
+
+	int mHasConstraintRectangle;
+	GeoRectangle2D mConstraintRectangle;
+} updateStageTileCaller;
+
+static void updateStageTileCallerLayerState(updateStageTileCaller* tCaller) {
+	StaticStageHandlerElement* e = tCaller->e;
+	tCaller->mIsVisible = !(e->mInvisibleFlag || e->mIsInvisible || !e->mIsEnabled);
+	if (!e->mIsEnabled) return;
+
+	const auto cameraStartPosition = getDreamCameraStartPosition(e->mCoordinates.x);
+	const auto heightDelta = cameraStartPosition.y - getDreamCameraPositionY(e->mCoordinates.x);
+	const auto heightScale = e->mScaleStartY + (e->mScaleDeltaY * heightDelta);
+	tCaller->mTotalScale = e->mDrawScale * e->mGlobalScale * Vector2D(1, heightScale) * e->mTileBaseScale * e->mParallaxScale;
+	tCaller->mIsTotalScaleChanged = !e->mIsTileDrawScaleSet || tCaller->mTotalScale.x != e->mTileDrawScale.x || tCaller->mTotalScale.y != e->mTileDrawScale.y;
+	e->mTileDrawScale = tCaller->mTotalScale;
+	e->mIsTileDrawScaleSet = 1;
+	tCaller->mHasMultipleTiles = e->mAnimationReferences.size() > 1;
+
 	if (e->mIsParallax) {
-		offset.x = getAnimationFirstElementSpriteSize(e->mAnimation, e->mSprites).x / 2.0;
+		const auto deltaInCameraSpaceDrawScaled = (e->mTileBasePosition + Vector2D(-e->mCoordinates.x / 2, 0)) - e->mStart - e->mSinOffset - e->mSinOffsetInternal;
+		const auto deltaInElementSpaceBottom = deltaInCameraSpaceDrawScaled * e->mXScale.y;
+		auto bottomPosition = vecAdd(e->mStart + e->mSinOffset + e->mSinOffsetInternal, deltaInElementSpaceBottom);
+		bottomPosition.x -= (-e->mCoordinates.x / 2);
+		tCaller->mParallaxBottomBasePosition = bottomPosition;
 	}
 
-	int totalSizeX, totalSizeY;
-	const auto stepAmount = vector_size(&e->mAnimation->mSteps);
-	if (stepAmount > 1) {
-		totalSizeX = e->mTileSpacing.x;
-		totalSizeY = e->mTileSpacing.y;
+	if (e->mTile.x == 1 || e->mTile.y == 1) {
+		tCaller->mTileAmount = getTileAmount(e);
+		tCaller->mSpriteOffset = getAnimationFirstElementSpriteOffset(e->mAnimation, e->mSprites);
+		if (e->mIsParallax) {
+			tCaller->mSpriteOffset.x = getAnimationFirstElementSpriteSize(e->mAnimation, e->mSprites).x / 2.0;
+		}
+
+		const auto stepAmount = vector_size(&e->mAnimation->mSteps);
+		if (stepAmount > 1) {
+			tCaller->mTotalTileSize = e->mTileSpacing;
+		}
+		else {
+			tCaller->mTotalTileSize = Vector2DI(e->mTileSize.x + e->mTileSpacing.x, e->mTileSize.y + e->mTileSpacing.y);
+		}
+		tCaller->mScreenSize = getScreenSize();
 	}
-	else {
-		totalSizeX = e->mTileSize.x + e->mTileSpacing.x;
-		totalSizeY = e->mTileSize.y + e->mTileSpacing.y;
+
+	tCaller->mHasConstraintRectangle = e->mConstraintRectangleDelta.x != 0.0 || e->mConstraintRectangleDelta.y != 0.0;
+	if (tCaller->mHasConstraintRectangle) {
+		const auto windowDelta = (Position2D(getDreamCameraPositionX(getDreamMugenStageHandlerCameraCoordinateP()), getDreamCameraPositionY(getDreamMugenStageHandlerCameraCoordinateP())) * -1.0) * e->mConstraintRectangleDelta;
+		tCaller->mConstraintRectangle = e->mConstraintRectangle + windowDelta;
 	}
+}
+
+static void updateSingleStaticStageElementTileTiling(updateStageTileCaller* tCaller, StageElementAnimationReference* tSingleAnimation) {
+	StaticStageHandlerElement* e = tCaller->e;
+	const auto& amount = tCaller->mTileAmount;
+	const auto& offset = tCaller->mSpriteOffset;
+	const auto& totalScale = tCaller->mTotalScale;
+	const auto& sz = tCaller->mScreenSize;
 
-	const auto sz = getScreenSize();
 	if (e->mTile.x == 1) {
-		const auto right = tSingleAnimation->mReferencePosition.x * (1.0 / tTotalScale.x) + e->mTileSize.x - offset.x + std::max(0.0, getMugenAnimationShearLowerOffsetX(tSingleAnimation->mElement));
+		const auto right = tSingleAnimation->mReferencePosition.x * (1.0 / totalScale.x) + e->mTileSize.x - offset.x + std::max(0.0, getMugenAnimationShearLowerOffsetX(tSingleAnimation->mElement));
 		if (right < 0) {
-			tSingleAnimation->mOffset.x += amount.x*totalSizeX;
+			tSingleAnimation->mOffset.x += amount.x * tCaller->mTotalTileSize.x;
 		}
-		const auto left = tSingleAnimation->mReferencePosition.x * (1.0 / tTotalScale.x) - offset.x + std::min(0.0, getMugenAnimationShearLowerOffsetX(tSingleAnimation->mElement));
+		const auto left = tSingleAnimation->mReferencePosition.x * (1.0 / totalScale.x) - offset.x + std::min(0.0, getMugenAnimationShearLowerOffsetX(tSingleAnimation->mElement));
 		if (left > sz.x) {
-			tSingleAnimation->mOffset.x -= amount.x*totalSizeX;
+			tSingleAnimation->mOffset.x -= amount.x * tCaller->mTotalTileSize.x;
 		}
 	}
 
 	if (e->mTile.y == 1) {
-		const auto down = tSingleAnimation->mReferencePosition.y * (1.0 / tTotalScale.y) + e->mTileSize.y - offset.y;
+		const auto down = tSingleAnimation->mReferencePosition.y * (1.0 / totalScale.y) + e->mTileSize.y - offset.y;
 		if (down < 0) {
-			tSingleAnimation->mOffset.y += amount.y*totalSizeY;
+			tSingleAnimation->mOffset.y += amount.y * tCaller->mTotalTileSize.y;
 		}
-		const auto up = tSingleAnimation->mReferencePosition.y * (1.0 / tTotalScale.y) - offset.y;
+		const auto up = tSingleAnimation->mReferencePosition.y * (1.0 / totalScale.y) - offset.y;
 		if (up > sz.y) {
-			tSingleAnimation->mOffset.y -= amount.y*totalSizeY;
+			tSingleAnimation->mOffset.y -= amount.y * tCaller->mTotalTileSize.y;
 		}
 	}
 }
 
-static void updateSingleStaticStageElementTilePositionAndScale(StaticStageHandlerElement* e, StageElementAnimationReference* tSingleAnimation, Vector2D& oTotalScale) {
+static void updateSingleStaticStageElementTilePositionAndScale(updateStageTileCaller* tCaller, StageElementAnimationReference* tSingleAnimation) {
+	StaticStageHandlerElement* e = tCaller->e;
 	tSingleAnimation->mReferencePosition = vecAdd(e->mTileBasePosition, tSingleAnimation->mOffset);
 	tSingleAnimation->mReferencePosition = vecScale2D(tSingleAnimation->mReferencePosition, e->mGlobalScale * e->mParallaxScale);
 	tSingleAnimation->mReferencePosition.z++;
 
-	const auto cameraStartPosition = getDreamCameraStartPosition(e->mCoordinates.x);
-	const auto heightDelta = cameraStartPosition.y - getDreamCameraPositionY(e->mCoordinates.x);
-	const auto heightScale = e->mScaleStartY + (e->mScaleDeltaY * heightDelta);
-	oTotalScale = e->mDrawScale * e->mGlobalScale * Vector2D(1, heightScale) * e->mTileBaseScale * e->mParallaxScale;
-	setMugenAnimationDrawScale(tSingleAnimation->mElement, oTotalScale);
+	if (tCaller->mIsTotalScaleChanged) {
+		setMugenAnimationDrawScale(tSingleAnimation->mElement, tCaller->mTotalScale);
+	}
 
 	if (e->mIsParallax) {
-		const auto deltaInCameraSpaceDrawScaled = (e->mTileBasePosition + Vector2D(-e->mCoordinates.x / 2, 0)) - e->mStart - e->mSinOffset - e->mSinOffsetInternal;
-		const auto deltaInElementSpaceBottom = deltaInCameraSpaceDrawScaled * e->mXScale.y;
-		auto bottomPosition = vecAdd(e->mStart + e->mSinOffset + e->mSinOffsetInternal, deltaInElementSpaceBottom);
-		bottomPosition.x -= (-e->mCoordinates.x / 2);
-		bottomPosition = vecAdd(bottomPosition, tSingleAnimation->mOffset);
+		auto bottomPosition = vecAdd(tCaller->mParallaxBottomBasePosition, tSingleAnimation->mOffset);
 		bottomPosition = vecScale2D(bottomPosition, e->mGlobalScale * e->mParallaxScale);
 		double shearOffsetToFitTiling;
-		if (e->mAnimationReferences.size() > 1) {
-			const auto centerOffset = (e->mCoordinates.x / 2) - tSingleAnimation->mReferencePosition.x * (1.0 / oTotalScale.x);
+		if (tCaller->mHasMultipleTiles) {
+			const auto centerOffset = (e->mCoordinates.x / 2) - tSingleAnimation->mReferencePosition.x * (1.0 / tCaller->mTotalScale.x);
 			shearOffsetToFitTiling = centerOffset * (1.0 - e->mWidth.y);
 		}
 		else {
@@ -172,31 +217,28 @@ static void updateSingleStaticStageElementTilePositionAndScale(StaticStageHandle
 	}
 }
 
-static void updateSingleStaticStageElementTileConstraintRectangle(StaticStageHandlerElement* e, StageElementAnimationReference* tSingleAnimation) {
-	if (e->mConstraintRectangleDelta.x == 0.0 && e->mConstraintRectangleDelta.y == 0.0) return;
-	const auto windowDelta = (Position2D(getDreamCameraPositionX(getDreamMugenStageHandlerCameraCoordinateP()), getDreamCameraPositionY(getDreamMugenStageHandlerCameraCoordinateP())) * -1.0) * e->mConstraintRectangleDelta;
-	const auto movedConstraintRectangle = e->mConstraintRectangle + windowDelta;
-	setMugenAnimationConstraintRectangle(tSingleAnimation->mElement, movedConstraintRectangle);
+static void updateSingleStaticStageElementTileConstraintRectangle(updateStageTileCaller* tCaller, StageElementAnimationReference* tSingleAnimation) {
+	if (!tCaller->mHasConstraintRectangle) return;
+	setMugenAnimationConstraintRectangle(tSingleAnimation->mElement, tCaller->mConstraintRectangle);
 }
 
-static void updateSingleStaticStageElementTileVisibility(StaticStageHandlerElement* e, StageElementAnimationReference* tSingleAnimation) { 
-		setMugenAnimationVisibility(tSingleAnimation->mElement, !(e->mInvisibleFlag || e->mIsInvisible || !e->mIsEnabled));
+static void updateSingleStaticStageElementTileVisibility(updateStageTileCaller* tCaller, StageElementAnimationReference* tSingleAnimation) { 
+		setMugenAnimationVisibility(tSingleAnimation->mElement, tCaller->mIsVisible);
 }
 
-static void updateSingleStaticStageElementTile(StaticStageHandlerElement* e, StageElementAnimationReference* tSingleAnimation) {
-	updateSingleStaticStageElementTileVisibility(e, tSingleAnimation);
-	if (!e->mIsEnabled) return;
+static void updateSingleStaticStageElementTile(updateStageTileCaller* tCaller, StageElementAnimationReference* tSingleAnimation) {
+	updateSingleStaticStageElementTileVisibility(tCaller, tSingleAnimation);
+	if (!tCaller->e->mIsEnabled) return;
 
-	Vector2D totalScale;
-	updateSingleStaticStageElementTilePositionAndScale(e, tSingleAnimation, totalScale);
-	updateSingleStaticStageElementTileTiling(e, tSingleAnimation, totalScale);
-	updateSingleStaticStageElementTileConstraintRectangle(e, tSingleAnimation);
+	updateSingleStaticStageElementTilePositionAndScale(tCaller, tSingleAnimation);
+	updateSingleStaticStageElementTileTiling(tCaller, tSingleAnimation);
+	updateSingleStaticStageElementTileConstraintRectangle(tCaller, tSingleAnimation);
 }
 
 static void updateSingleStaticStageElementTileCB(updateStageTileCaller* tCaller, StageElementAnimationReference& tData) {
 	StageElementAnimationReference* singleAnimation = &tData;
 
-	updateSingleStaticStageElementTile(tCaller->e, singleAnimation);
+	updateSingleStaticStageElementTile(tCaller, singleAnimation);
 }
 
 static void updateSingleStaticStageElementVisibilityFlag(StaticStageHandlerElement* e) {
@@ -241,13 +283,53 @@ static void updateSingleStaticStageElementBasePosition(StaticStageHandlerElement
 	e->mTileBaseScale = e->mScaleStart + scaleDelta;
 }
 
+static int isStaticStageElementOutsideCamera(updateStageTileCaller* tCaller) {
+	StaticStageHandlerElement* e = tCaller->e;
+	if (!e->mIsCullable || !e->mIsEnabled) return 0;
+	const auto& totalScale = tCaller->mTotalScale;
+	if (totalScale.x <= 0 || totalScale.y <= 0 || gMugenStageHandlerData.mCameraZoom.x <= 0) return 0;
+
+	const auto sz = getScreenSize();
+	const auto zoom = std::min(1.0, gMugenStageHandlerData.mCameraZoom.x);
+	const auto marginFactor = ((1.0 / zoom) - 1.0) / 2 + STAGE_ELEMENT_CULLING_MARGIN_FACTOR;
+	const auto marginX = sz.x * marginFactor;
+	const auto marginY = sz.y * marginFactor;
+
+	const auto positionScale = e->mGlobalScale * e->mParallaxScale;
+	const auto left = (e->mTileBasePosition.x + e->mTileOffsetMin.x) * positionScale.x * (1.0 / totalScale.x) - e->mTileSize.x;
+	const auto right = (e->mTileBasePosition.x + e->mTileOffsetMax.x) * positionScale.x * (1.0 / totalScale.x) + e->mTileSize.x;
+	const auto up = (e->mTileBasePosition.y + e->mTileOffsetMin.y) * positionScale.y * (1.0 / totalScale.y) - e->mTileSize.y;
+	const auto down = (e->mTileBasePosition.y + e->mTileOffsetMax.y) * positionScale.y * (1.0 / totalScale.y) + e->mTileSize.y;
+	return right < -marginX || left > sz.x + marginX || down < -marginY || up > sz.y + marginY;
+}
+
+static void hideSingleStaticStageElementTileCB(void* tCaller, StageElementAnimationReference& tData) {
+	(void)tCaller;
+	setMugenAnimationVisibility(tData.mElement, 0);
+}
+
+static void setSingleStaticStageElementCulled(StaticStageHandlerElement* e, int tIsCulled) {
+	if (tIsCulled && !e->mIsCulled) {
+		stl_list_map(e->mAnimationReferences, hideSingleStaticStageElementTileCB);
+	}
+	if (tIsCulled) {
+		e->mIsTileDrawScaleSet = 0;
+	}
+	e->mIsCulled = tIsCulled;
+}
+
 static void updateSingleStaticStageElement(StaticStageHandlerElement* e) {
 	updateSingleStaticStageElementVelocity(e);
 	updateSingleStaticStageElementBasePosition(e);
 	
 	updateStageTileCaller caller;
 	caller.e = e;
-	stl_list_map(e->mAnimationReferences, updateSingleStaticStageElementTileCB, &caller);	
+	updateStageTileCallerLayerState(&caller);
+	const auto isCulled = isStaticStageElementOutsideCamera(&caller);
+	setSingleStaticStageElementCulled(e, isCulled);
+	if (!isCulled) {
+		stl_list_map(e->mAnimationReferences, updateSingleStaticStageElementTileCB, &caller);
+	}
 	updateSingleStaticStageElementVisibilityFlag(e);
 	updateSingleStaticStageElementSin(e);
 }
@@ -359,6 +441,7 @@ void resetDreamMugenStageHandler()
 		staticElement.mSinOffsetInternal = Vector2D(0, 0);
 		staticElement.mIsInvisible = 0;
 		staticElement.mIsEnabled = 1;
+		staticElement.mIsTileDrawScaleSet = 0;
 		for (auto& animationElement : staticElement.mAnimationReferences)
 		{
 			animationElement.mOffset = animationElement.mStartPosition;
@@ -440,6 +523,19 @@ static void addMugenStageHandlerBackgroundElementTiles(StaticStageHandlerElement
 
 }
 
+static void initStaticStageElementCulling(StaticStageHandlerElement* e) {
+	e->mIsCulled = 0;
+	e->mIsCullable = e->mAnimation && !e->mAnimationReferences.empty() && !e->mIsParallax && e->mTile.x != 1 && e->mTile.y != 1 && vector_size(&e->mAnimation->mSteps) == 1;
+	if (!e->mIsCullable) return;
+
+	e->mTileOffsetMin = Vector2D(INF, INF);
+	e->mTileOffsetMax = Vector2D(-INF, -INF);
+	for (const auto& animationElement : e->mAnimationReferences) {
+		e->mTileOffsetMin = Vector2D(std::min(e->mTileOffsetMin.x, animationElement.mStartPosition.x), std::min(e->mTileOffsetMin.y, animationElement.mStartPosition.y));
+		e->mTileOffsetMax = Vector2D(std::max(e->mTileOffsetMax.x, animationElement.mStartPosition.x), std::max(e->mTileOffsetMax.y, animationElement.mStartPosition.y));
+	}
+}
+
 static void addStaticElementToIDList(StaticStageHandlerElement* e, int tID) {
 	StageElementIDList* elementList;
 	if (!stl_map_contains(gMugenStageHandlerData.mStageElementsFromID, tID)) {
@@ -512,6 +608,7 @@ void addDreamMugenStageHandlerAnimatedBackgroundElement(const Position& tStart,
 
 	e->mTileBasePosition = Vector3D(0, 0, 0);
 	e->mTileBaseScale = Vector2D(1.0, 1.0);
+	e->mIsTileDrawScaleSet = 0;
 	if (!tPositionLink || gMugenStageHandlerData.mStaticElements.size() <= 1) {
 		e->mPositionLinkElement = NULL;
 	} else {
@@ -523,6 +620,7 @@ void addDreamMugenStageHandlerAnimatedBackgroundElement(const Position& tStart,
 	if (e->mAnimation) {
 		addMugenStageHandlerBackgroundElementTiles(e, tSprites, tTile, tBlendType, tAlpha, tZoomDelta);
 	}
+	initStaticStageElementCulling(e);
 	updateSingleStaticStageElement(e);
 
 	addStaticElementToIDList(e, tID);
@@ -726,6 +824,7 @@ static void changeSingleMugenAnimationReference(int* tCaller, StageElementAnimat
 
 void setStageElementAnimation(StaticStageHandlerElement * tElement, int tAnimation)
 {
+	tElement->mIsCullable = 0; // the culling bound was derived from the original sprite
 	stl_list_map(tElement->mAnimationReferences, changeSingleMugenAnimationReference, &tAnimation);
 }
 
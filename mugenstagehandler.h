@@ -69,6 +69,13 @@ typedef struct StaticStageHandlerElement_t {
 
 	Position mTileBasePosition;
 	Vector2D mTileBaseScale;
+	Vector2D mTileDrawScale; // shared by all tiles, only pushed to the tile elements when it changes
+	int mIsTileDrawScaleSet;
+
+	int mIsCullable; // single-step, non-parallax elements without infinite tiling
+	int mIsCulled;
+	Vector2D mTileOffsetMin;
+	Vector2D mTileOffsetMax;
 	struct StaticStageHandlerElement_t* mPositionLinkElement;
 } StaticStageHandlerElement;
 
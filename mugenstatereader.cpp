@@ -10,6 +10,7 @@
 #include <prism/stlutil.h>
 
 #include "mugenstatecontrollers.h"
+#include "characterpackage.h"
 
 using namespace std;
 
@@ -311,7 +312,7 @@ static void loadMugenStateDefinitionsFromScript(DreamMugenStates* tStates, Mugen
 
 void loadDreamMugenStateDefinitionsFromFile(DreamMugenStates* tStates, const char* tPath, int tIsOverwritable) {
 	MugenDefScript script; 
-	loadMugenDefScript(&script, tPath);
+	loadCharacterMugenDefScript(&script, tPath);
 	loadMugenStateDefinitionsFromScript(tStates, &script, tIsOverwritable);
 	unloadMugenDefScript(&script);
 }
@@ -463,7 +464,7 @@ static void loadMugenConstantsFromScript(DreamMugenConstants* tConstants, MugenD
 DreamMugenConstants loadDreamMugenConstantsFile(const char * tPath)
 {
 	MugenDefScript script; 
-	loadMugenDefScript(&script, tPath);
+	loadCharacterMugenDefScript(&script, tPath);
 	DreamMugenConstants ret = makeEmptyMugenConstants();
 	loadMugenConstantsFromScript(&ret, &script);
 	unloadMugenDefScript(&script);
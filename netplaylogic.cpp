@@ -1,9 +1,54 @@
 #include "netplaylogic.h"
 
+#include <assert.h>
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+
 #include <prism/netplay.h>
 
 using namespace prism;
 
+struct NetplayLoopbackPacket {
+	std::vector<char> mData;
+	uint32_t mSequence;
+	int mDeliveryTime;
+};
+
+struct NetplayLoopbackRecordedPacket {
+	std::vector<char> mData;
+	int mSendTime;
+};
+
+typedef enum {
+	NETPLAY_LOOPBACK_MODE_INACTIVE,
+	NETPLAY_LOOPBACK_MODE_ECHO,
+	NETPLAY_LOOPBACK_MODE_RECORDING,
+	NETPLAY_LOOPBACK_MODE_AGAINST_RECORDING,
+} NetplayLoopbackMode;
+
+// packet contents are kept in std containers, since the recorded peer stream has to outlive the screen it was sent in
+static struct {
+	NetplayLoopbackMode mLoopbackMode;
+	DolmexicaNetplayLoopbackSettings mLoopbackSettings;
+	std::list<NetplayLoopbackPacket> mPacketsInFlight;
+	std::map<uint32_t, std::vector<char>> mArrivedPackets; // held back until every earlier sequence arrived or was lost
+	std::set<uint32_t> mLostSequences;
+	std::list<std::vector<char>> mDeliveredPackets;
+	uint32_t mNextSentSequence;
+	uint32_t mNextDeliveredSequence;
+
+	std::vector<NetplayLoopbackRecordedPacket> mRecordedPackets;
+	size_t mRecordedPlaybackPosition;
+
+	uint32_t mRandomState;
+	int mNow;
+	int mDroppedAmount;
+} gNetplayLogicData;
+
 void initDolmexicaNetplay()
 {
 	initNetplay();
@@ -32,4 +77,177 @@ void updateDolmexicaNetplay()
 
 bool isDolmexicaNetplayHost() {
 	return isNetplayHost();
-}
\ No newline at end of file
+}
+
+// the loopback has its own generator so simulated network conditions never advance the fight's random state
+static double getNetplayLoopbackRandom() {
+	gNetplayLogicData.mRandomState = gNetplayLogicData.mRandomState * 1664525u + 1013904223u;
+	return (gNetplayLogicData.mRandomState >> 8) / double(1u << 24);
+}
+
+static int getNetplayLoopbackRandomInteger(int tMin, int tMax) {
+	if (tMax <= tMin) return tMin;
+	return tMin + int(getNetplayLoopbackRandom() * (tMax - tMin + 1));
+}
+
+static void transmitLoopbackPacket(const char* tData, uint32_t tLength) {
+	const auto& settings = gNetplayLogicData.mLoopbackSettings;
+	const auto sequence = gNetplayLogicData.mNextSentSequence++;
+	if (getNetplayLoopbackRandom() < settings.mLossProbability) {
+		gNetplayLogicData.mLostSequences.insert(sequence);
+		gNetplayLogicData.mDroppedAmount++;
+		return;
+	}
+
+	NetplayLoopbackPacket packet;
+	packet.mData = std::vector<char>(tData, tData + tLength);
+	packet.mSequence = sequence;
+	packet.mDeliveryTime = gNetplayLogicData.mNow + settings.mDelay + getNetplayLoopbackRandomInteger(0, settings.mJitter);
+	if (!gNetplayLogicData.mPacketsInFlight.empty() && getNetplayLoopbackRandom() < settings.mReorderProbability) {
+		packet.mDeliveryTime = std::min(packet.mDeliveryTime, gNetplayLogicData.mPacketsInFlight.back().mDeliveryTime - 1);
+		gNetplayLogicData.mPacketsInFlight.insert(std::prev(gNetplayLogicData.mPacketsInFlight.end()), packet);
+	}
+	else {
+		gNetplayLogicData.mPacketsInFlight.push_back(packet);
+	}
+}
+
+static void transmitDueRecordedLoopbackPackets() {
+	auto& position = gNetplayLogicData.mRecordedPlaybackPosition;
+	while (position < gNetplayLogicData.mRecordedPackets.size() && gNetplayLogicData.mRecordedPackets[position].mSendTime <= gNetplayLogicData.mNow) {
+		const auto& data = gNetplayLogicData.mRecordedPackets[position].mData;
+		transmitLoopbackPacket(data.data(), uint32_t(data.size()));
+		position++;
+	}
+}
+
+// packets may arrive out of order, but are handed on in send order like the real connection does
+static void deliverDueLoopbackPackets() {
+	auto it = gNetplayLogicData.mPacketsInFlight.begin();
+	while (it != gNetplayLogicData.mPacketsInFlight.end()) {
+		if (it->mDeliveryTime <= gNetplayLogicData.mNow) {
+			gNetplayLogicData.mArrivedPackets[it->mSequence] = it->mData;
+			it = gNetplayLogicData.mPacketsInFlight.erase(it);
+		}
+		else {
+			it++;
+		}
+	}
+
+	auto& nextSequence = gNetplayLogicData.mNextDeliveredSequence;
+	while (true) {
+		if (gNetplayLogicData.mLostSequences.erase(nextSequence)) {
+			nextSequence++;
+			continue;
+		}
+		const auto arrived = gNetplayLogicData.mArrivedPackets.find(nextSequence);
+		if (arrived == gNetplayLogicData.mArrivedPackets.end()) break;
+		gNetplayLogicData.mDeliveredPackets.push_back(arrived->second);
+		gNetplayLogicData.mArrivedPackets.erase(arrived);
+		nextSequence++;
+	}
+}
+
+static void resetNetplayLoopback(NetplayLoopbackMode tMode, const DolmexicaNetplayLoopbackSettings& tSettings) {
+	gNetplayLogicData.mPacketsInFlight.clear();
+	gNetplayLogicData.mArrivedPackets.clear();
+	gNetplayLogicData.mLostSequences.clear();
+	gNetplayLogicData.mDeliveredPackets.clear();
+	gNetplayLogicData.mNextSentSequence = 0;
+	gNetplayLogicData.mNextDeliveredSequence = 0;
+	gNetplayLogicData.mRecordedPlaybackPosition = 0;
+	gNetplayLogicData.mLoopbackSettings = tSettings;
+	gNetplayLogicData.mRandomState = tSettings.mSeed;
+	gNetplayLogicData.mNow = 0;
+	gNetplayLogicData.mDroppedAmount = 0;
+	gNetplayLogicData.mLoopbackMode = tMode;
+}
+
+void startDolmexicaNetplayLoopback(const DolmexicaNetplayLoopbackSettings& tSettings)
+{
+	resetNetplayLoopback(NETPLAY_LOOPBACK_MODE_ECHO, tSettings);
+}
+
+void startDolmexicaNetplayLoopbackRecording()
+{
+	DolmexicaNetplayLoopbackSettings settings;
+	settings.mDelay = settings.mJitter = 0;
+	settings.mReorderProbability = settings.mLossProbability = 0.0;
+	settings.mSeed = 0;
+	resetNetplayLoopback(NETPLAY_LOOPBACK_MODE_RECORDING, settings);
+	gNetplayLogicData.mRecordedPackets.clear();
+}
+
+void startDolmexicaNetplayLoopbackAgainstRecording(const DolmexicaNetplayLoopbackSettings& tSettings)
+{
+	resetNetplayLoopback(NETPLAY_LOOPBACK_MODE_AGAINST_RECORDING, tSettings);
+}
+
+void stopDolmexicaNetplayLoopback()
+{
+	resetNetplayLoopback(NETPLAY_LOOPBACK_MODE_INACTIVE, gNetplayLogicData.mLoopbackSettings);
+}
+
+// ticked by the fight netplay actor only, so the simulated clock advances exactly once per fight frame
+void updateDolmexicaNetplayLoopback()
+{
+	if (gNetplayLogicData.mLoopbackMode == NETPLAY_LOOPBACK_MODE_INACTIVE) return;
+
+	gNetplayLogicData.mNow++;
+	if (gNetplayLogicData.mLoopbackMode == NETPLAY_LOOPBACK_MODE_AGAINST_RECORDING) {
+		transmitDueRecordedLoopbackPackets();
+	}
+	deliverDueLoopbackPackets();
+}
+
+bool isDolmexicaNetplayLoopbackActive()
+{
+	return gNetplayLogicData.mLoopbackMode != NETPLAY_LOOPBACK_MODE_INACTIVE;
+}
+
+bool isDolmexicaNetplayLoopbackRecording()
+{
+	return gNetplayLogicData.mLoopbackMode == NETPLAY_LOOPBACK_MODE_RECORDING;
+}
+
+void sendDolmexicaNetplayData(const Buffer& tData)
+{
+	switch (gNetplayLogicData.mLoopbackMode) {
+	case NETPLAY_LOOPBACK_MODE_ECHO:
+		transmitLoopbackPacket((const char*)tData.mData, tData.mLength);
+		break;
+	case NETPLAY_LOOPBACK_MODE_RECORDING:
+	{
+		NetplayLoopbackRecordedPacket packet;
+		packet.mData = std::vector<char>((const char*)tData.mData, (const char*)tData.mData + tData.mLength);
+		packet.mSendTime = gNetplayLogicData.mNow;
+		gNetplayLogicData.mRecordedPackets.push_back(packet);
+		break;
+	}
+	case NETPLAY_LOOPBACK_MODE_AGAINST_RECORDING:
+		break; // the recorded peer has already run, so there is nobody left to receive
+	default:
+		sendNetplayData(tData);
+		break;
+	}
+}
+
+bool hasDolmexicaNetplayLoopbackData()
+{
+	return !gNetplayLogicData.mDeliveredPackets.empty();
+}
+
+Buffer popDolmexicaNetplayLoopbackData()
+{
+	assert(hasDolmexicaNetplayLoopbackData());
+	const auto& data = gNetplayLogicData.mDeliveredPackets.front();
+	Buffer ret = makeBufferEmptyOwned();
+	appendBufferBuffer(&ret, makeBuffer((void*)data.data(), uint32_t(data.size())));
+	gNetplayLogicData.mDeliveredPackets.pop_front();
+	return ret;
+}
+
+int getDolmexicaNetplayLoopbackDroppedAmount()
+{
+	return gNetplayLogicData.mDroppedAmount;
+}
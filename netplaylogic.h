@@ -2,6 +2,18 @@
 
 #include <string>
 
+#include <prism/file.h>
+
+using namespace prism;
+
+struct DolmexicaNetplayLoopbackSettings {
+	int mDelay;
+	int mJitter;
+	double mReorderProbability;
+	double mLossProbability;
+	uint32_t mSeed;
+};
+
 void initDolmexicaNetplay();
 
 void startDolmexicaNetplayHost(void(tJoinedCB)(void*));
@@ -9,4 +21,16 @@ void stopDolmexicaNetplayHost();
 bool tryDolmexicaNetplayJoin(const std::string& tHostIP, void(tJoinedCB)(void*));
 
 void updateDolmexicaNetplay();
-bool isDolmexicaNetplayHost();
\ No newline at end of file
+bool isDolmexicaNetplayHost();
+
+void startDolmexicaNetplayLoopback(const DolmexicaNetplayLoopbackSettings& tSettings);
+void startDolmexicaNetplayLoopbackRecording();
+void startDolmexicaNetplayLoopbackAgainstRecording(const DolmexicaNetplayLoopbackSettings& tSettings);
+void stopDolmexicaNetplayLoopback();
+void updateDolmexicaNetplayLoopback();
+bool isDolmexicaNetplayLoopbackActive();
+bool isDolmexicaNetplayLoopbackRecording();
+void sendDolmexicaNetplayData(const Buffer& tData);
+bool hasDolmexicaNetplayLoopbackData();
+Buffer popDolmexicaNetplayLoopbackData();
+int getDolmexicaNetplayLoopbackDroppedAmount();
@@ -3,6 +3,8 @@
 #include <assert.h>
 #include <string.h>
 #include <algorithm>
+#include <memory>
+#include <vector>
 
 #include <prism/file.h>
 #include <prism/physicshandler.h>
@@ -36,6 +38,7 @@
 #include "mugensound.h"
 #include "mugenanimationutilities.h"
 #include "mugenexplod.h"
+#include "characterpackage.h"
 #include "pausecontrollers.h"
 #include "config.h"
 #include "mugenassignmentevaluator.h"
@@ -51,9 +54,26 @@ using namespace std;
 #define CENTER_POINT_Z 49
 #define PLAYER_DEBUG_TEXT_Z 79
 
+#define HELPER_STORE_SLAB_SIZE 16
+
+typedef struct {
+	int mReferenceCount;
+	MugenAnimations mAnimations;
+	MugenSounds mSounds;
+} SharedPlayerAssets;
+
+typedef struct {
+	std::vector<std::unique_ptr<DreamPlayer[]>> mSlabs; // slabs never move, so helper pointers stay valid until the store is cleared
+	std::vector<int> mFreeSlots;
+	std::vector<int> mIsSlotUsed;
+	std::vector<std::unique_ptr<DreamPlayerVariables>> mSlotVariables; // allocated on first helper use, or when a projectile outlives its helper
+	std::vector<int> mSlotGenerations; // bumped on free and kept across fights, so references to a reused slot never validate
+} HelperStore;
+
 static struct {
 	DreamPlayerHeader mPlayerHeader[2];
 	DreamPlayer mPlayers[2];
+	DreamPlayerVariables mPlayerVariables[2];
 	int mUniqueIDCounter;
 	int mIsInTrainingMode;
 	int mIsCollisionDebugActive;
@@ -62,10 +82,62 @@ static struct {
 	int mHasLoadedSprites;
 
 	List mAllPlayers; // contains DreamPlayer
-	std::set<DreamPlayer*> mAllProjectiles;
-	std::unordered_map<int, DreamPlayer> mHelperStore;
+	HelperStore mHelperStore; // recycled helper and projectile slots
+	std::map<std::string, SharedPlayerAssets> mSharedAssets; // keyed by definition path, shared by mirror matches; lives for one fight since the parsed assets sit on screen memory
+
+	PlayerHitEvents mHitEvents; // reset every tick
 } gPlayerDefinition;
 
+static int allocateHelperStoreSlot() {
+	auto& store = gPlayerDefinition.mHelperStore;
+	if (store.mFreeSlots.empty()) {
+		const auto slabStart = int(store.mIsSlotUsed.size());
+		store.mSlabs.push_back(std::unique_ptr<DreamPlayer[]>(new DreamPlayer[HELPER_STORE_SLAB_SIZE]()));
+		store.mIsSlotUsed.resize(slabStart + HELPER_STORE_SLAB_SIZE, 0);
+		store.mSlotVariables.resize(slabStart + HELPER_STORE_SLAB_SIZE);
+		if (int(store.mSlotGenerations.size()) < slabStart + HELPER_STORE_SLAB_SIZE) store.mSlotGenerations.resize(slabStart + HELPER_STORE_SLAB_SIZE, 0);
+		for (int i = slabStart + HELPER_STORE_SLAB_SIZE - 1; i >= slabStart; i--) {
+			store.mFreeSlots.push_back(i);
+		}
+	}
+
+	const auto slot = store.mFreeSlots.back();
+	store.mFreeSlots.pop_back();
+	store.mIsSlotUsed[slot] = 1;
+	return slot;
+}
+
+static DreamPlayer* getHelperStoreSlot(int tSlot) {
+	return &gPlayerDefinition.mHelperStore.mSlabs[tSlot / HELPER_STORE_SLAB_SIZE][tSlot % HELPER_STORE_SLAB_SIZE];
+}
+
+static DreamPlayerVariables* getHelperStoreSlotVariables(int tSlot) {
+	auto& variables = gPlayerDefinition.mHelperStore.mSlotVariables[tSlot];
+	if (!variables) variables.reset(new DreamPlayerVariables());
+	return variables.get();
+}
+
+static int isHelperStoreSlotUsed(int tSlot) {
+	const auto& store = gPlayerDefinition.mHelperStore;
+	return tSlot >= 0 && tSlot < int(store.mIsSlotUsed.size()) && store.mIsSlotUsed[tSlot];
+}
+
+static void freeHelperStoreSlot(int tSlot) {
+	auto& store = gPlayerDefinition.mHelperStore;
+	store.mIsSlotUsed[tSlot] = 0;
+	store.mSlotGenerations[tSlot]++;
+	store.mFreeSlots.push_back(tSlot);
+}
+
+static void clearHelperStore() {
+	auto& store = gPlayerDefinition.mHelperStore;
+	store.mSlabs.clear();
+	store.mFreeSlots.clear();
+	store.mIsSlotUsed.clear();
+	store.mSlotVariables.clear();
+	for (auto& generation : store.mSlotGenerations) generation++;
+}
+
 static void loadPlayerHeaderFromScript(DreamPlayerHeader* tHeader, MugenDefScript* tScript) {
 	getMugenDefStringOrDefault(tHeader->mConstants.mName, tScript, "info", "name", "Character");
 	getMugenDefStringOrDefault(tHeader->mConstants.mDisplayName, tScript, "info", "displayname", tHeader->mConstants.mName);
@@ -89,7 +161,7 @@ static void loadOptionalStateFiles(MugenDefScript* tScript, char* tPath, DreamPl
 		sprintf(name, "st%d", i);
 		getMugenDefStringOrDefault(file, tScript, "files", name, "");
 		sprintf(scriptPath, "%s%s", tPath, file);
-		if (!isFile(scriptPath)) continue;
+		if (!isCharacterFile(scriptPath)) continue;
 		
 		loadDreamMugenStateDefinitionsFromFile(&tPlayer->mHeader->mFiles.mConstants.mStates, scriptPath);
 		logMemoryState();
@@ -139,6 +211,50 @@ static int parsePlayerPreferredPalette(int tPalette, MugenDefScript* tScript) {
 	}
 }
 
+static void loadSharedPlayerAssets(SharedPlayerAssets* e, char* tPath, MugenDefScript* tScript) {
+	char file[200];
+	char scriptPath[1024];
+
+	getMugenDefStringOrDefault(file, tScript, "files", "anim", "");
+	assert(strcmp("", file));
+	sprintf(scriptPath, "%s%s", tPath, file);
+	e->mAnimations = loadMugenAnimationFile(scriptPath);
+	logMemoryState();
+
+	getMugenDefStringOrDefault(file, tScript, "files", "sound", "");
+	sprintf(scriptPath, "%s%s", tPath, file);
+	if (isFile(scriptPath)) {
+		setSoundEffectCompression(1);
+		e->mSounds = loadMugenSoundFile(scriptPath);
+		setSoundEffectCompression(0);
+	}
+	else {
+		e->mSounds = createEmptyMugenSoundFile();
+	}
+	logMemoryState();
+}
+
+static void acquireSharedPlayerAssets(DreamPlayer* tPlayer, char* tPath, MugenDefScript* tScript) {
+	auto& e = gPlayerDefinition.mSharedAssets[tPlayer->mHeader->mFiles.mDefinitionPath];
+	if (!e.mReferenceCount) {
+		loadSharedPlayerAssets(&e, tPath, tScript);
+	}
+	e.mReferenceCount++;
+
+	tPlayer->mHeader->mFiles.mAnimations = e.mAnimations;
+	tPlayer->mHeader->mFiles.mSounds = e.mSounds;
+}
+
+static void releaseSharedPlayerAssets(DreamPlayerHeader* tHeader) {
+	const auto it = gPlayerDefinition.mSharedAssets.find(tHeader->mFiles.mDefinitionPath);
+	if (it == gPlayerDefinition.mSharedAssets.end()) return;
+	if (--it->second.mReferenceCount) return;
+
+	unloadMugenAnimationFile(&it->second.mAnimations);
+	unloadMugenSoundFile(&it->second.mSounds);
+	gPlayerDefinition.mSharedAssets.erase(it);
+}
+
 static void loadPlayerFiles(char* tPath, DreamPlayer* tPlayer, MugenDefScript* tScript) {
 	char file[200];
 	char path[1024];
@@ -164,7 +280,7 @@ static void loadPlayerFiles(char* tPath, DreamPlayer* tPlayer, MugenDefScript* t
 	
 	getMugenDefStringOrDefault(file, tScript, "files", "stcommon", "");
 	sprintf(scriptPath, "%s%s", path, file);
-	if (isFile(scriptPath)) {
+	if (isCharacterFile(scriptPath)) {
 		loadDreamMugenStateDefinitionsFromFile(&tPlayer->mHeader->mFiles.mConstants.mStates, scriptPath, 1);
 	}
 	else {
@@ -177,7 +293,7 @@ static void loadPlayerFiles(char* tPath, DreamPlayer* tPlayer, MugenDefScript* t
 
 	getMugenDefStringOrDefault(file, tScript, "files", "st", "");
 	sprintf(scriptPath, "%s%s", path, file);
-	if (isFile(scriptPath)) {
+	if (isCharacterFile(scriptPath)) {
 		loadDreamMugenStateDefinitionsFromFile(&tPlayer->mHeader->mFiles.mConstants.mStates, scriptPath);
 	}
 	logMemoryState();
@@ -191,11 +307,7 @@ static void loadPlayerFiles(char* tPath, DreamPlayer* tPlayer, MugenDefScript* t
 
 	resetDreamAssignmentCommandLookupID();
 
-	getMugenDefStringOrDefault(file, tScript, "files", "anim", "");
-	assert(strcmp("", file));
-	sprintf(scriptPath, "%s%s", path, file);
-	tPlayer->mHeader->mFiles.mAnimations = loadMugenAnimationFile(scriptPath);
-	logMemoryState();
+	acquireSharedPlayerAssets(tPlayer, path, tScript);
 
 	char palettePath[1024];
 	const auto preferredPalette = parsePlayerPreferredPalette(tPlayer->mPreferredPalette, tScript);
@@ -211,18 +323,6 @@ static void loadPlayerFiles(char* tPath, DreamPlayer* tPlayer, MugenDefScript* t
 	tPlayer->mHeader->mFiles.mPalettePath = copyToAllocatedString(palettePath);
 	tPlayer->mHeader->mFiles.mSpritePath = copyToAllocatedString(scriptPath);
 
-	getMugenDefStringOrDefault(file, tScript, "files", "sound", "");
-	sprintf(scriptPath, "%s%s", path, file);
-	if (isFile(scriptPath)) {
-		setSoundEffectCompression(1);
-		tPlayer->mHeader->mFiles.mSounds = loadMugenSoundFile(scriptPath);
-		setSoundEffectCompression(0);
-	}
-	else {
-		tPlayer->mHeader->mFiles.mSounds = createEmptyMugenSoundFile();
-	}
-	logMemoryState();
-
 	setPlayerExternalDependencies(tPlayer);
 
 	if (getPlayerAILevel(tPlayer) || (getGameMode() == GAME_MODE_TRAINING && tPlayer->mRootID == 1)) {
@@ -232,15 +332,17 @@ static void loadPlayerFiles(char* tPath, DreamPlayer* tPlayer, MugenDefScript* t
 
 static void initHitDefAttributeSlot(DreamHitDefAttributeSlot* tSlot) {
 	tSlot->mIsActive = 0;
+	tSlot->mAttributeFlags = 0;
 	tSlot->mNow = 0;
 }
 
+static void clearPlayerReceivedHits(DreamPlayer* p);
+
 static void resetHelperState(DreamPlayer* p) {
 	p->mHelpers = new_list();
 	p->mProjectiles = new_int_map();
 
-	p->mReceivedHitData.clear();
-	p->mReceivedReversalDefPlayers.clear();
+	clearPlayerReceivedHits(p);
 	p->mActiveTargets.clear();
 
 	p->mNoWalkFlag = 0;
@@ -330,10 +432,8 @@ static void resetHelperState(DreamPlayer* p) {
 }
 
 static void loadPlayerState(DreamPlayer* p) {
-	memset(p->mVars, 0, sizeof p->mVars);
-	memset(p->mSystemVars, 0, sizeof p->mSystemVars);
-	memset(p->mFloatVars, 0, sizeof p->mFloatVars);
-	memset(p->mSystemFloatVars, 0, sizeof p->mSystemFloatVars);
+	p->mVariables = &gPlayerDefinition.mPlayerVariables[p->mRootID];
+	memset(p->mVariables, 0, sizeof *p->mVariables);
 	
 	p->mID = 0;
 
@@ -341,12 +441,12 @@ static void loadPlayerState(DreamPlayer* p) {
 	p->mIsAlive = 1;
 	p->mRoundsWon = 0;
 
+	p->mHelperIDInStore = -1; // before the hit data takes its reference
 	resetHelperState(p);
 	p->mIsHelper = 0;
 	p->mParent = getPlayerRoot(p);
 	p->mHelperIDInParent = -1;
 	p->mHelperIDInRoot = -1;
-	p->mHelperIDInStore = -1;
 
 	p->mIsProjectile = 0;
 	p->mProjectileID = -1;
@@ -402,6 +502,10 @@ static void loadPlayerShadow(DreamPlayer* p) {
 static void loadPlayerReflection(DreamPlayer* p) {
 	const auto pos = getDreamStageCoordinateSystemOffset(getDreamMugenStageHandlerCameraCoordinateP()).xyz(REFLECTION_Z);
 	p->mReflection.mPosition = *getHandledPhysicsPositionReference(p->mPhysicsElement);
+	if (getDreamStageReflectionTransparency() <= 0) {
+		p->mReflection.mAnimationElement = NULL; // only stages with reflections pay for the extra animation element
+		return;
+	}
 	p->mReflection.mAnimationElement = addMugenAnimation(getMugenAnimation(&p->mHeader->mFiles.mAnimations, getMugenAnimationAnimationNumber(p->mAnimationElement)), gPlayerDefinition.mIsLoading ? NULL : &p->mHeader->mFiles.mSprites, pos);
 
 	setMugenAnimationBasePosition(p->mReflection.mAnimationElement, &p->mReflection.mPosition);
@@ -414,8 +518,8 @@ static void loadPlayerReflection(DreamPlayer* p) {
 	setMugenAnimationFaceDirection(p->mReflection.mAnimationElement, getMugenAnimationIsFacingRight(p->mAnimationElement));
 }
 
-static void loadPlayerDebug(DreamPlayer* p) {
-	setMugenAnimationCollisionDebug(p->mAnimationElement, gPlayerDefinition.mIsCollisionDebugActive);
+static void loadPlayerDebugText(DreamPlayer* p) {
+	if (p->mDebug.mCollisionTextID != -1) return;
 
 	char text[2];
 	text[0] = '\0';
@@ -423,10 +527,20 @@ static void loadPlayerDebug(DreamPlayer* p) {
 	setMugenTextAlignment(p->mDebug.mCollisionTextID, MUGEN_TEXT_ALIGNMENT_CENTER);
 }
 
+static void loadPlayerDebug(DreamPlayer* p) {
+	setMugenAnimationCollisionDebug(p->mAnimationElement, gPlayerDefinition.mIsCollisionDebugActive);
+
+	p->mDebug.mCollisionTextID = -1;
+	if (gPlayerDefinition.mIsCollisionDebugActive) {
+		loadPlayerDebugText(p);
+	}
+}
+
 static void loadSinglePlayerFromMugenDefinition(DreamPlayer* p)
 {
+	loadCharacterPackage(p->mHeader->mFiles.mDefinitionPath);
 	MugenDefScript script; 
-	loadMugenDefScript(&script, p->mHeader->mFiles.mDefinitionPath);
+	loadCharacterMugenDefScript(&script, p->mHeader->mFiles.mDefinitionPath);
 
 	loadPlayerState(p);
 	loadPlayerHeaderFromScript(p->mHeader, &script);
@@ -436,6 +550,7 @@ static void loadSinglePlayerFromMugenDefinition(DreamPlayer* p)
 	loadPlayerStateWithConstantsLoaded(p);
 	loadPlayerDebug(p);
 	unloadMugenDefScript(&script);
+	unloadCharacterPackage();
 }
 
 void loadPlayers(MemoryStack* tMemoryStack) {
@@ -443,9 +558,10 @@ void loadPlayers(MemoryStack* tMemoryStack) {
 
 	gPlayerDefinition.mIsLoading = 1;
 
-	gPlayerDefinition.mHelperStore.clear();
+	clearHelperStore();
+	gPlayerDefinition.mSharedAssets.clear();
 	gPlayerDefinition.mAllPlayers = new_list();
-	gPlayerDefinition.mAllProjectiles.clear();
+	clearPlayerHitEvents(&gPlayerDefinition.mHitEvents);
 	list_push_back(&gPlayerDefinition.mAllPlayers, &gPlayerDefinition.mPlayers[0]);
 	list_push_back(&gPlayerDefinition.mAllPlayers, &gPlayerDefinition.mPlayers[1]);
 
@@ -472,7 +588,7 @@ static void loadSinglePlayerSprites(DreamPlayer* tPlayer) {
 
 	setMugenAnimationSprites(tPlayer->mAnimationElement, &tPlayer->mHeader->mFiles.mSprites);
 	setMugenAnimationSprites(tPlayer->mShadow.mAnimationElement, &tPlayer->mHeader->mFiles.mSprites);
-	setMugenAnimationSprites(tPlayer->mReflection.mAnimationElement, &tPlayer->mHeader->mFiles.mSprites);
+	if (tPlayer->mReflection.mAnimationElement) setMugenAnimationSprites(tPlayer->mReflection.mAnimationElement, &tPlayer->mHeader->mFiles.mSprites);
 }
 
 void loadPlayerSprites() {
@@ -488,16 +604,14 @@ static void unloadHelperStateWithoutFreeingOwnedHelpersAndProjectile(DreamPlayer
 	// projectiles shouldn't have helpers, so no need to move them
 	delete_list(&p->mHelpers);
 	delete_int_map(&p->mProjectiles);
-	p->mReceivedHitData.clear();
-	p->mReceivedReversalDefPlayers.clear();
+	clearPlayerReceivedHits(p);
 	p->mActiveTargets.clear();
 
 	delete_list(&p->mBoundHelpers);
 }
 
 static void unloadPlayerState(DreamPlayer* p) {
-	p->mReceivedHitData.clear();
-	p->mReceivedReversalDefPlayers.clear();
+	clearPlayerReceivedHits(p);
 	p->mActiveTargets.clear();
 	clearPlayerHitData(p);
 	removePlayerAfterImage(p);
@@ -506,9 +620,8 @@ static void unloadPlayerState(DreamPlayer* p) {
 static void unloadPlayerFiles(DreamPlayerHeader* tHeader) {
 	unloadDreamMugenConstantsFile(&tHeader->mFiles.mConstants);
 	unloadDreamMugenCommandFile(&tHeader->mFiles.mCommands);
-	unloadMugenAnimationFile(&tHeader->mFiles.mAnimations);
+	releaseSharedPlayerAssets(tHeader);
 	unloadMugenSpriteFile(&tHeader->mFiles.mSprites);
-	unloadMugenSoundFile(&tHeader->mFiles.mSounds);
 }
 
 static void unloadSinglePlayer(DreamPlayer* p, DreamPlayerHeader* tHeader) {
@@ -531,8 +644,7 @@ void unloadPlayers() {
 		unloadSinglePlayer(&gPlayerDefinition.mPlayers[i], &gPlayerDefinition.mPlayerHeader[i]);
 	}
 
-	gPlayerDefinition.mHelperStore.clear();
-	gPlayerDefinition.mAllProjectiles.clear();
+	clearHelperStore();
 }
 
 static void removeSingleHelperCB(void* /*tCaller*/, void* tData) {
@@ -704,7 +816,7 @@ static void setPlayerFaceDirection(DreamPlayer* p, FaceDirection tDirection) {
 
 	setMugenAnimationFaceDirection(p->mAnimationElement, tDirection == FACE_DIRECTION_RIGHT);
 	setMugenAnimationFaceDirection(p->mShadow.mAnimationElement, getMugenAnimationIsFacingRight(p->mAnimationElement));
-	setMugenAnimationFaceDirection(p->mReflection.mAnimationElement, getMugenAnimationIsFacingRight(p->mAnimationElement));
+	if (p->mReflection.mAnimationElement) setMugenAnimationFaceDirection(p->mReflection.mAnimationElement, getMugenAnimationIsFacingRight(p->mAnimationElement));
 
 	if (!p->mIsHelper) {
 		setDreamMugenCommandFaceDirection(p->mCommandID, tDirection);
@@ -784,7 +896,7 @@ static void updateHitPause(DreamPlayer* p) {
 }
 
 static void updateBindingPosition(DreamPlayer* p) {
-	DreamPlayer* bindRoot = p->mBoundTarget;
+	DreamPlayer* bindRoot = getReferencedPlayer(p->mBoundTarget);
 	auto pos = getPlayerPosition(bindRoot, getDreamMugenStageHandlerCameraCoordinateP());
 
 	if (p->mBoundPositionType == PLAYER_BIND_POSITION_TYPE_HEAD) {
@@ -813,7 +925,7 @@ static void removePlayerBindingInternal(DreamPlayer* tPlayer) {
 	if (!tPlayer->mIsBound) return;
 	tPlayer->mIsBound = 0;
 
-	DreamPlayer* boundTo = tPlayer->mBoundTarget;
+	DreamPlayer* boundTo = getReferencedPlayer(tPlayer->mBoundTarget);
 	if (!isPlayer(boundTo)) return;
 	list_remove(&boundTo->mBoundHelpers, tPlayer->mBoundID);
 }
@@ -823,7 +935,7 @@ static void updateBinding(DreamPlayer* p) {
 	if (isPlayerPaused(p)) return;
 
 	p->mBoundNow++;
-	if (!isPlayer(p->mBoundTarget) || p->mBoundNow >= p->mBoundDuration) {
+	if (!isPlayer(getReferencedPlayer(p->mBoundTarget)) || p->mBoundNow >= p->mBoundDuration) {
 		removePlayerBindingInternal(p);
 		return;
 	}
@@ -998,7 +1110,7 @@ static void updateScale(DreamPlayer* p) {
 	const auto drawScale = Vector2D(getPlayerScaleX(p), getPlayerScaleY(p)) * p->mTempScale * getPlayerToCameraScale(p);
 	setMugenAnimationDrawScale(p->mAnimationElement, drawScale);
 	setMugenAnimationDrawScale(p->mShadow.mAnimationElement, Vector2D(1, -getDreamStageShadowScaleY()) * drawScale);
-	setMugenAnimationDrawScale(p->mReflection.mAnimationElement, Vector2D(1, -1) * drawScale);
+	if (p->mReflection.mAnimationElement) setMugenAnimationDrawScale(p->mReflection.mAnimationElement, Vector2D(1, -1) * drawScale);
 	p->mTempScale = Vector2D(1, 1);
 }
 
@@ -1089,7 +1201,7 @@ static void updateShadow(DreamPlayer* p) {
 static void updateReflection(DreamPlayer* p) {
 	p->mReflection.mPosition = *getHandledPhysicsPositionReference(p->mPhysicsElement);
 	if (!p->mInvisibilityFlag) {
-		setMugenAnimationVisibility(p->mReflection.mAnimationElement, p->mReflection.mPosition.y <= 0);
+		if (p->mReflection.mAnimationElement) setMugenAnimationVisibility(p->mReflection.mAnimationElement, p->mReflection.mPosition.y <= 0);
 	}
 	p->mReflection.mPosition.y *= -1;
 
@@ -1103,8 +1215,6 @@ static void updatePlayerPhysicsClamp(DreamPlayer* p) {
 	if (fabs(vel->y) < PHYSICS_EPSILON) vel->y = 0;
 }
 
-static void clearPlayerReceivedHits(DreamPlayer* p);
-
 static void updateSingleProjectilePreStateMachine(DreamPlayer* p) {
 	p->mTimeDilatationNow += p->mTimeDilatation;
 	p->mTimeDilatationUpdates = (int)p->mTimeDilatationNow;
@@ -1180,7 +1290,7 @@ static void updateActiveTargets(DreamPlayer* p) {
 	while (it != p->mActiveTargets.end()) {
 		auto current = it;
 		it++;
-		auto otherPlayer = current->second;
+		auto otherPlayer = getReferencedPlayer(current->second);
 		if (!isPlayer(otherPlayer) || getPlayerStateMoveType(otherPlayer) != MUGEN_STATE_MOVE_TYPE_BEING_HIT || getPlayerControl(otherPlayer)) {
 			p->mActiveTargets.erase(current);
 		}
@@ -1235,13 +1345,37 @@ static int updatePlayerPauseStopAndReturnIfStopped(DreamPlayer* p) {
 	return 0;
 }
 
+static void clearSinglePlayerReferencesCB(void* tCaller, void* tData) {
+	DreamPlayer* destroyedPlayer = (DreamPlayer*)tCaller;
+	DreamPlayer* p = (DreamPlayer*)tData;
+
+	if (p->mParent == destroyedPlayer) p->mParent = getPlayerRoot(p); // projectiles outliving their helper
+	if (isPlayerHelper(destroyedPlayer) && p->mVariables == destroyedPlayer->mVariables) { // the next helper in the slot takes over the shared block
+		DreamPlayerVariables* variables = getHelperStoreSlotVariables(p->mHelperIDInStore);
+		*variables = *destroyedPlayer->mVariables;
+		p->mVariables = variables;
+	}
+}
+
+// targets, reversals, bindings, hit data and explods hold generation checked references, only raw pointers are cleared here
+static void clearPlayerReferences(DreamPlayer* p) {
+	list_map(&gPlayerDefinition.mAllPlayers, clearSinglePlayerReferencesCB, p);
+	mapActiveProjectiles(clearSinglePlayerReferencesCB, p);
+	for (int i = 0; i < gPlayerDefinition.mHitEvents.mAmount; i++) {
+		auto& e = gPlayerDefinition.mHitEvents.mEvents[i];
+		if (e.mReceiver == p) e.mReceiver = NULL;
+		if (e.mAttacker == p) e.mAttacker = NULL;
+	}
+}
+
 static void updatePlayerDestruction(DreamPlayer* p) {
-	if (gPlayerDefinition.mHelperStore.find(p->mHelperIDInStore) == gPlayerDefinition.mHelperStore.end()) {
+	if (!isHelperStoreSlotUsed(p->mHelperIDInStore)) {
 		logErrorFormat("Unable to delete helper %d %d, unable to find id %d in store. Ignoring.", p->mRootID, p->mID, p->mHelperIDInStore);
 		return;
 	}
 	removeDreamRegisteredStateMachine(p->mRegisteredStateMachine);
-	gPlayerDefinition.mHelperStore.erase(p->mHelperIDInStore);
+	clearPlayerReferences(p);
+	freeHelperStoreSlot(p->mHelperIDInStore);
 }
 
 static int updateSinglePlayer(DreamPlayer* p) {
@@ -1291,6 +1425,7 @@ void updatePlayers()
 	for (i = 0; i < 2; i++) {
 		updateSinglePlayer(&gPlayerDefinition.mPlayers[i]);
 	}
+	clearPlayerHitEvents(&gPlayerDefinition.mHitEvents);
 }
 
 static void updatePlayersWithCaller(void* /*tCaller*/) {
@@ -1557,21 +1692,17 @@ static void setPlayerHitStates(DreamPlayer* p, DreamPlayer* tOtherPlayer, int tH
 	}
 }
 
-static int checkPlayerHitGuardFlagsAndReturnIfGuardable(DreamPlayer* tPlayer, char* tFlags) {
+static int checkPlayerHitGuardFlagsAndReturnIfGuardable(DreamPlayer* tPlayer, uint32_t tFlags) {
 	setProfilingSectionMarkerCurrentFunction();
 	DreamMugenStateType type = getPlayerStateType(tPlayer);
-	char test[100];
-	strcpy(test, tFlags);
-	turnStringLowercase(test);
 
 	if (type == MUGEN_STATE_TYPE_STANDING) {
-
-		return strchr(test, 'h') != NULL || strchr(test, 'm') != NULL;
+		return (tFlags & MUGEN_HIT_FLAG_HIGH_FLAG) != 0;
 	} else  if (type == MUGEN_STATE_TYPE_CROUCHING) {
-		return strchr(test, 'l') != NULL || strchr(test, 'm') != NULL;
+		return (tFlags & MUGEN_HIT_FLAG_LOW_FLAG) != 0;
 	}
 	else  if (type == MUGEN_STATE_TYPE_AIR) {
-		return strchr(test, 'a') != NULL;
+		return (tFlags & MUGEN_HIT_FLAG_AIR_FLAG) != 0;
 	}
 	else {
 		logWarningFormat("Unrecognized player type %d. Defaulting to unguardable.", type);
@@ -1619,7 +1750,7 @@ static void handlePlayerCornerPush(DreamPlayer* p, DreamPlayer* tOtherPlayer) {
 static void addPlayerAsActiveTarget(DreamPlayer* p, DreamPlayer* tNewTarget) {
 	if (isPlayerProjectile(tNewTarget)) return;
 
-	p->mActiveTargets.insert(std::make_pair(getActiveHitDataHitID(tNewTarget), tNewTarget));
+	p->mActiveTargets.insert(std::make_pair(getActiveHitDataHitID(tNewTarget), getPlayerReference(tNewTarget)));
 }
 
 static void setPlayerForceStand(DreamPlayer* p) {
@@ -1684,13 +1815,13 @@ static void setPlayerHitPaletteEffects(DreamPlayer* p) {
 	setPlayerPaletteEffect(p, duration, getActiveHitDataPaletteEffectAddition(p), getActiveHitDataPaletteEffectMultiplication(p), Vector3D(0, 0, 0), 1, 0, 1.0, 0);
 }
 
-static void setPlayerHit(DreamPlayer* p, DreamPlayer* tOtherPlayer, void* tHitData) {
+static void setPlayerHit(DreamPlayer* p, DreamPlayer* tOtherPlayer, const PlayerHitEvent& tEvent) {
 	setProfilingSectionMarkerCurrentFunction();
 	setPlayerControl(p, 0);
 	stopSoundEffect(parsePlayerSoundEffectChannel(0, p));
 	removeExplodsForPlayerAfterHit(p);
 
-	copyHitDataToActive(p, tHitData);
+	copyHitEventDataToActive(p, tEvent);
 
 	const auto player2ChangeFaceDirectionRelativeToPlayer1 = getActiveHitDataPlayer2ChangeFaceDirectionRelativeToPlayer1(p);
 	if (player2ChangeFaceDirectionRelativeToPlayer1) {
@@ -1705,7 +1836,7 @@ static void setPlayerHit(DreamPlayer* p, DreamPlayer* tOtherPlayer, void* tHitDa
 		setPlayerIsFacingRight(p, !getActiveHitDataIsFacingRight(p));
 	}
 
-	if (getPlayerUnguardableFlag(tOtherPlayer) || (isPlayerGuarding(p) && !checkPlayerHitGuardFlagsAndReturnIfGuardable(p, getActiveHitDataGuardFlag(p)))) {
+	if (getPlayerUnguardableFlag(tOtherPlayer) || (isPlayerGuarding(p) && !checkPlayerHitGuardFlagsAndReturnIfGuardable(p, getActiveHitDataGuardFlagFlags(p)))) {
 		setPlayerUnguarding(p);
 	}
 
@@ -1825,79 +1956,16 @@ static void playPlayerHitSpark(DreamPlayer* p1, DreamPlayer* p2, DreamPlayer* tF
 	playDreamHitSpark(tSparkOffset, tFileOwner, tIsInPlayerFile, tNumber, getActiveHitDataIsFacingRight(p1), getDreamMugenStageHandlerCameraCoordinateP());
 }
 
-typedef struct {
-	int mFound;
-	MugenAttackType mType;
-	MugenAttackClass mClass;
-} HitDefAttributeFlag2Caller;
-
-static void checkSingleFlag2InHitDefAttributeSlot(HitDefAttributeFlag2Caller* tCaller, const std::string& tFlag) {
-	if (tFlag.size() != 2) {
-		logWarningFormat("Unable to check hitdef attribute flag %s, invalid size.", tFlag.c_str());
-		return;
-	}
-	if (tFlag[0] != 'a') {
-		if (tCaller->mClass == MUGEN_ATTACK_CLASS_NORMAL) {
-			if (tFlag[0] != 'n') return;
-		}
-		else if (tCaller->mClass == MUGEN_ATTACK_CLASS_SPECIAL) {
-			if (tFlag[0] != 's') return;
-		}
-		else if (tCaller->mClass == MUGEN_ATTACK_CLASS_HYPER) {
-			if (tFlag[0] != 'h') return;
-		}
-		else {
-			logWarningFormat("Unrecognized attack class %d. Defaulting to not found.", tCaller->mClass);
-			return;
-		}
-	}
-
-	if (tCaller->mType == MUGEN_ATTACK_TYPE_ATTACK) {
-		if (tFlag[1] != 'a') return;
-	} 
-	else if (tCaller->mType == MUGEN_ATTACK_TYPE_PROJECTILE) {
-		if (tFlag[1] != 'p') return;
-	}
-	else if (tCaller->mType == MUGEN_ATTACK_TYPE_THROW) {
-		if (tFlag[1] != 't') return;
-	}
-	else {
-		logWarningFormat("Unrecognized attack type %d. Defaulting to not found.", tCaller->mType);
-		return;
-	}
-
-	tCaller->mFound = 1;
-}
-
 static int checkSingleNoHitDefSlot(DreamHitDefAttributeSlot* tSlot, DreamPlayer* p2) {
 	if (!tSlot->mIsActive) return 1;
 
-	DreamMugenStateType type = getHitDataType(p2);
-
-	if (type == MUGEN_STATE_TYPE_STANDING) {
-		if (tSlot->mFlag1.find('s') != tSlot->mFlag1.npos) return tSlot->mIsHitBy;
-	} 
-	else if (type == MUGEN_STATE_TYPE_CROUCHING) {
-		if (tSlot->mFlag1.find('c') != tSlot->mFlag1.npos) return tSlot->mIsHitBy;
-	}
-	else if (type == MUGEN_STATE_TYPE_AIR) {
-		if (tSlot->mFlag1.find('a') != tSlot->mFlag1.npos) return tSlot->mIsHitBy;
-	}
-	else {
-		logWarningFormat("Invalid hitdef type %d. Defaulting to not not hit.", type);
+	const auto hitDataFlags = getHitDataAttributeFlags(p2);
+	if (!(hitDataFlags & MUGEN_HIT_DEF_ATTRIBUTE_STATE_TYPE_MASK)) {
+		logWarningFormat("Invalid hitdef type %d. Defaulting to not not hit.", getHitDataType(p2));
 		return 0;
 	}
 
-	HitDefAttributeFlag2Caller caller;
-	caller.mFound = 0;
-	caller.mType = getHitDataAttackType(p2);
-	caller.mClass = getHitDataAttackClass(p2);
-
-	for (size_t i = 0; i < tSlot->mFlag2.size(); i++) {
-		checkSingleFlag2InHitDefAttributeSlot(&caller, tSlot->mFlag2[i]);
-	}
-
-	if (caller.mFound) return tSlot->mIsHitBy;
+	if (tSlot->mAttributeFlags & hitDataFlags) return tSlot->mIsHitBy;
 	else return !tSlot->mIsHitBy;
 }
 
@@ -1910,6 +1978,13 @@ static int checkActiveHitDefAttributeSlots(DreamPlayer* p, DreamPlayer* p2) {
 	return 1;
 }
 
+static int isIgnoredBecauseOfHitFlag(DreamPlayer* p, PlayerHitData* tHitData) {
+	if (isPlayerProjectile(p)) return 0;
+
+	const auto isGettingHit = getPlayerStateMoveType(p) == MUGEN_STATE_MOVE_TYPE_BEING_HIT;
+	return !isMugenHitFlagMatching(tHitData->mHitFlagFlags, getPlayerStateType(p), isGettingHit, isPlayerFalling(p), isPlayerGuarding(p));
+}
+
 static int isIgnoredBecauseOfJuggle(DreamPlayer* p, DreamPlayer* tOtherPlayer) {
 	int isJuggableState;
 
@@ -1961,8 +2036,10 @@ static int isReversalDefActiveForHit(DreamPlayer* p, DreamPlayer* tOtherPlayer)
 	if (!isHitDataReversalDefActive(p)) return 0;
 	if (isPlayerProjectile(tOtherPlayer)) return 0;
 	if (!checkSingleNoHitDefSlot(getHitDataReversalDefReversalAttribute(p), tOtherPlayer)) return 0;
-	if (p->mReceivedReversalDefPlayers.find(tOtherPlayer) == p->mReceivedReversalDefPlayers.end()) return 0;
-	return 1;
+	for (const auto& reversalPlayer : p->mReceivedReversalDefPlayers) {
+		if (isPlayerReferenceTo(reversalPlayer, tOtherPlayer)) return 1;
+	}
+	return 0;
 }
 
 static void handleReversalDefHit(DreamPlayer* p, DreamPlayer* tOtherPlayer) {
@@ -2006,8 +2083,10 @@ static int checkHitPriorityTypeDisablingHit(const PlayerHitData& tGettingHitData
 }
 
 static int isHitDisabledDueToPriority(DreamPlayer* p, DreamPlayer* tOtherPlayer, const PlayerHitData& tGettingHitData) {
-	for (const auto& tOtherHitData : tOtherPlayer->mReceivedHitData) {
-		if (tOtherHitData.mPlayer != p) continue;
+	for (int i = 0; i < gPlayerDefinition.mHitEvents.mAmount; i++) {
+		const auto& e = gPlayerDefinition.mHitEvents.mEvents[i];
+		if (e.mReceiver != tOtherPlayer || e.mAttacker != p) continue;
+		const auto& tOtherHitData = *e.mHitData;
 		if (tGettingHitData.mPriority > tOtherHitData.mPriority) continue;
 		if (checkHitPriorityTypeDisablingHit(tGettingHitData, tOtherHitData)) return 1;
 	}
@@ -2022,14 +2101,13 @@ static int isProjectileHitDisabledDueToPriority(DreamPlayer* tHitProjectile, Dre
 	return prioHit > prioAttack;
 }
 
-static void playerHitEval(DreamPlayer* p, PlayerHitData& tHitDataReference) {
+static void playerHitEval(DreamPlayer* p, const PlayerHitEvent& tEvent) {
 	setProfilingSectionMarkerCurrentFunction();
 	if (!isValidPlayerOrProjectile(p)) return;
-	void* hitData = (void*)&tHitDataReference;
-	DreamPlayer* otherPlayer = getReceivedHitDataPlayer(hitData);
+	DreamPlayer* otherPlayer = tEvent.mAttacker;
 
 	if (!isPlayerHitStillValidAfterReceive(otherPlayer)) return;
-	if (isHitDisabledDueToPriority(p, otherPlayer, tHitDataReference)) return;
+	if (isHitDisabledDueToPriority(p, otherPlayer, *tEvent.mHitData)) return;
 	if (isReversalDefActiveForHit(p, otherPlayer)) {
 		handleReversalDefHit(p, otherPlayer);
 		return;
@@ -2039,7 +2117,7 @@ static void playerHitEval(DreamPlayer* p, PlayerHitData& tHitDataReference) {
 		return;
 	}
 
-	setPlayerHit(p, otherPlayer, hitData);
+	setPlayerHit(p, otherPlayer, tEvent);
 
 	const auto playerGuarding = isPlayerGuarding(p);
 	if (playerGuarding) {
@@ -2064,17 +2142,30 @@ static void playerHitEval(DreamPlayer* p, PlayerHitData& tHitDataReference) {
 	}
 }
 
+// receivers resolve in player update order, each one's hits in attacker order; no HitDef runs before the state machine, so the attacker's data still is the data that hit
 static void updatePlayerReceivedHits(DreamPlayer* p) {
 	setProfilingSectionMarkerCurrentFunction();
-	auto hitListCopy = p->mReceivedHitData;
-	stl_list_map(hitListCopy, playerHitEval, p);
+	for (int i = 0; i < gPlayerDefinition.mHitEvents.mAmount; i++) {
+		const auto& e = gPlayerDefinition.mHitEvents.mEvents[i];
+		if (e.mReceiver != p) continue;
+		if (!isValidPlayerOrProjectile(e.mAttacker)) continue;
+		playerHitEval(p, e);
+	}
 }
 
 static void clearPlayerReceivedHits(DreamPlayer* p) {
-	p->mReceivedHitData.clear();
+	for (int i = 0; i < gPlayerDefinition.mHitEvents.mAmount; i++) {
+		auto& e = gPlayerDefinition.mHitEvents.mEvents[i];
+		if (e.mReceiver == p) e.mReceiver = NULL;
+	}
 	p->mReceivedReversalDefPlayers.clear();
 }
 
+// player 1's side before player 2's, each root before its helpers and projectiles, which follow their store slots
+static int getPlayerHitEventOrder(DreamPlayer* tAttacker) {
+	return tAttacker->mRootID * (1 << 24) + tAttacker->mHelperIDInStore + 1;
+}
+
 static int isValidAffectTeam(DreamPlayer* p, DreamPlayer* attackingPlayer) {
 	const auto affectTeam = getHitDataAffectTeam(attackingPlayer);
 	if (affectTeam == MUGEN_AFFECT_TEAM_ENEMY) return p->mRootID != attackingPlayer->mRootID;
@@ -2103,13 +2194,13 @@ void playerHitCB(void* tData, void* tHitData, int /*tOtherCollisionList*/)
 
 	if (!isReceivedHitDataActive(receivedHitData)) return;
 	if (!checkActiveHitDefAttributeSlots(p, otherPlayer)) return;
+	if (isIgnoredBecauseOfHitFlag(p, receivedHitData)) return;
 	if (isIgnoredBecauseOfHitOverride(p, otherPlayer)) return;
 	if (isIgnoredBecauseOfJuggle(p, otherPlayer)) return;
 	if (getDreamTimeSinceKO() > getOverHitTime()) return;
 	
-	PlayerHitData copyHitData = *receivedHitData;
+	addPlayerHitEvent(&gPlayerDefinition.mHitEvents, p, otherPlayer, receivedHitData, getPlayerHitEventOrder(otherPlayer));
 	setReceivedHitDataInactive(tHitData);
-	p->mReceivedHitData.push_back(copyHitData);
 }
 
 void playerReversalHitCB(void* tData, void* tHitData, int tOtherCollisionList)
@@ -2118,9 +2209,12 @@ void playerReversalHitCB(void* tData, void* tHitData, int tOtherCollisionList)
 	if (p->mIsDestroyed) return;
 	if (tOtherCollisionList != getDreamPlayerAttackCollisionList(getPlayerOtherPlayer(p))->mID) return;
 	PlayerHitData* receivedHitData = (PlayerHitData*)tHitData;
-	const auto otherPlayer = receivedHitData->mPlayer;
-	if (otherPlayer->mIsDestroyed) return;
-	p->mReceivedReversalDefPlayers.insert(otherPlayer);
+	const auto otherPlayer = getReferencedPlayer(receivedHitData->mPlayer);
+	if (!otherPlayer || otherPlayer->mIsDestroyed) return;
+	for (const auto& reversalPlayer : p->mReceivedReversalDefPlayers) {
+		if (isPlayerReferenceTo(reversalPlayer, otherPlayer)) return;
+	}
+	p->mReceivedReversalDefPlayers.push_back(receivedHitData->mPlayer);
 }
 
 void setPlayerDefinitionPath(int i, const char * tDefinitionPath)
@@ -2143,6 +2237,11 @@ void setPlayerPreferredPaletteRandom(int i)
 	gPlayerDefinition.mPlayers[i].mPreferredPalette = -1;
 }
 
+int getPlayerPreferredPalette(int i)
+{
+	return gPlayerDefinition.mPlayers[i].mPreferredPalette;
+}
+
 DreamPlayer * getRootPlayer(int i)
 {
 	return &gPlayerDefinition.mPlayers[i];
@@ -2303,17 +2402,17 @@ void setPlayerMoveContactCounterActive(DreamPlayer* p) {
 
 int getPlayerVariable(DreamPlayer* p, int tIndex)
 {
-	return p->mVars[tIndex];
+	return p->mVariables->mVars[tIndex];
 }
 
 int * getPlayerVariableReference(DreamPlayer* p, int tIndex)
 {
-	return &p->mVars[tIndex];
+	return &p->mVariables->mVars[tIndex];
 }
 
 void setPlayerVariable(DreamPlayer* p, int tIndex, int tValue)
 {
-	p->mVars[tIndex] = tValue;
+	p->mVariables->mVars[tIndex] = tValue;
 }
 
 void addPlayerVariable(DreamPlayer* p, int tIndex, int tValue)
@@ -2325,12 +2424,12 @@ void addPlayerVariable(DreamPlayer* p, int tIndex, int tValue)
 
 int getPlayerSystemVariable(DreamPlayer* p, int tIndex)
 {
-	return p->mSystemVars[tIndex];
+	return p->mVariables->mSystemVars[tIndex];
 }
 
 void setPlayerSystemVariable(DreamPlayer* p, int tIndex, int tValue)
 {
-	p->mSystemVars[tIndex] = tValue;
+	p->mVariables->mSystemVars[tIndex] = tValue;
 }
 
 void addPlayerSystemVariable(DreamPlayer* p, int tIndex, int tValue)
@@ -2342,12 +2441,12 @@ void addPlayerSystemVariable(DreamPlayer* p, int tIndex, int tValue)
 
 double getPlayerFloatVariable(DreamPlayer* p, int tIndex)
 {
-	return p->mFloatVars[tIndex];
+	return p->mVariables->mFloatVars[tIndex];
 }
 
 void setPlayerFloatVariable(DreamPlayer* p, int tIndex, double tValue)
 {
-	p->mFloatVars[tIndex] = tValue;
+	p->mVariables->mFloatVars[tIndex] = tValue;
 }
 
 void addPlayerFloatVariable(DreamPlayer* p, int tIndex, double tValue)
@@ -2359,12 +2458,12 @@ void addPlayerFloatVariable(DreamPlayer* p, int tIndex, double tValue)
 
 double getPlayerSystemFloatVariable(DreamPlayer* p, int tIndex)
 {
-	return p->mSystemFloatVars[tIndex];
+	return p->mVariables->mSystemFloatVars[tIndex];
 }
 
 void setPlayerSystemFloatVariable(DreamPlayer* p, int tIndex, double tValue)
 {
-	p->mSystemFloatVars[tIndex] = tValue;
+	p->mVariables->mSystemFloatVars[tIndex] = tValue;
 }
 
 void addPlayerSystemFloatVariable(DreamPlayer* p, int tIndex, double tValue)
@@ -3023,11 +3122,11 @@ void changePlayerAnimationWithStartStep(DreamPlayer* p, int tNewAnimation, int t
 	MugenAnimation* newAnimation = getMugenAnimation(&p->mHeader->mFiles.mAnimations, tNewAnimation);
 	changeMugenAnimationWithStartStep(p->mAnimationElement, newAnimation, tStartStep);
 	changeMugenAnimationWithStartStep(p->mShadow.mAnimationElement, newAnimation, tStartStep);
-	changeMugenAnimationWithStartStep(p->mReflection.mAnimationElement, newAnimation, tStartStep);
+	if (p->mReflection.mAnimationElement) changeMugenAnimationWithStartStep(p->mReflection.mAnimationElement, newAnimation, tStartStep);
 
 	setMugenAnimationCoordinateSystemScale(p->mAnimationElement, 1.0);
 	setMugenAnimationCoordinateSystemScale(p->mShadow.mAnimationElement, 1.0);
-	setMugenAnimationCoordinateSystemScale(p->mReflection.mAnimationElement, 1.0);
+	if (p->mReflection.mAnimationElement) setMugenAnimationCoordinateSystemScale(p->mReflection.mAnimationElement, 1.0);
 }
 
 void changePlayerAnimationToPlayer2AnimationWithStartStep(DreamPlayer* p, int tNewAnimation, int tStartStep)
@@ -3046,12 +3145,12 @@ void changePlayerAnimationToPlayer2AnimationWithStartStep(DreamPlayer* p, int tN
 	MugenAnimation* newAnimation = getMugenAnimation(&otherPlayer->mHeader->mFiles.mAnimations, tNewAnimation);
 	changeMugenAnimationWithStartStep(p->mAnimationElement, newAnimation, tStartStep);
 	changeMugenAnimationWithStartStep(p->mShadow.mAnimationElement, newAnimation, tStartStep);
-	changeMugenAnimationWithStartStep(p->mReflection.mAnimationElement, newAnimation, tStartStep);
+	if (p->mReflection.mAnimationElement) changeMugenAnimationWithStartStep(p->mReflection.mAnimationElement, newAnimation, tStartStep);
 
 	const auto playerCoordinateSystemScale = getPlayerCoordinateP(p) / double(getPlayerCoordinateP(otherPlayer));
 	setMugenAnimationCoordinateSystemScale(p->mAnimationElement, playerCoordinateSystemScale);
 	setMugenAnimationCoordinateSystemScale(p->mShadow.mAnimationElement, playerCoordinateSystemScale);
-	setMugenAnimationCoordinateSystemScale(p->mReflection.mAnimationElement, playerCoordinateSystemScale);
+	if (p->mReflection.mAnimationElement) setMugenAnimationCoordinateSystemScale(p->mReflection.mAnimationElement, playerCoordinateSystemScale);
 }
 
 void setPlayerAnimationFinishedCallback(DreamPlayer* p, void(*tFunc)(void *), void * tCaller)
@@ -3110,7 +3209,7 @@ void setPlayerInvisibleFlag(DreamPlayer* p)
 {
 	setMugenAnimationInvisibleForOneFrame(p->mAnimationElement); 
 	setMugenAnimationInvisibleForOneFrame(p->mShadow.mAnimationElement);
-	setMugenAnimationInvisibleForOneFrame(p->mReflection.mAnimationElement);
+	if (p->mReflection.mAnimationElement) setMugenAnimationInvisibleForOneFrame(p->mReflection.mAnimationElement);
 	p->mInvisibilityFlag = 1;
 }
 
@@ -3368,7 +3467,7 @@ static void pausePlayer(DreamPlayer* p) {
 	pauseHandledPhysics(p->mPhysicsElement);
 	pauseMugenAnimation(p->mAnimationElement);
 	pauseMugenAnimation(p->mShadow.mAnimationElement);
-	pauseMugenAnimation(p->mReflection.mAnimationElement);
+	if (p->mReflection.mAnimationElement) pauseMugenAnimation(p->mReflection.mAnimationElement);
 	pauseDreamRegisteredStateMachine(p->mRegisteredStateMachine);
 }
 
@@ -3376,7 +3475,7 @@ static void forceUnpausePlayer(DreamPlayer* p) {
 	resumeHandledPhysics(p->mPhysicsElement);
 	unpauseMugenAnimation(p->mAnimationElement);
 	unpauseMugenAnimation(p->mShadow.mAnimationElement);
-	unpauseMugenAnimation(p->mReflection.mAnimationElement);
+	if (p->mReflection.mAnimationElement) unpauseMugenAnimation(p->mReflection.mAnimationElement);
 	unpauseDreamRegisteredStateMachine(p->mRegisteredStateMachine);
 	p->mIsHitPaused = 0;
 }
@@ -3461,7 +3560,8 @@ int getPlayerTargetAmountWithID(DreamPlayer* p, int tID)
 {
 	int amount = 0;
 	for (const auto& targetPair : p->mActiveTargets) {
-		if (!isPlayer(targetPair.second)) continue;
+		const auto target = getReferencedPlayer(targetPair.second);
+		if (!isPlayer(target)) continue;
 		if (tID == -1 || tID == targetPair.first) {
 			amount++;
 		}
@@ -3473,9 +3573,10 @@ DreamPlayer* getPlayerTargetWithID(DreamPlayer* p, int tID)
 {
 	DreamPlayer* returnPlayer = NULL;
 	for (const auto& targetPair : p->mActiveTargets) {
-		if (!isPlayer(targetPair.second)) continue;
+		const auto target = getReferencedPlayer(targetPair.second);
+		if (!isPlayer(target)) continue;
 		if (tID == -1 || tID == targetPair.first) {
-			returnPlayer = targetPair.second;
+			returnPlayer = target;
 		}
 	}
 	return returnPlayer;
@@ -4402,12 +4503,36 @@ void setPlayerDoesScaleProjectiles(DreamPlayer* p, int tDoesScaleProjectiles)
 	p->mCustomSizeData.mDoesScaleProjectiles = tDoesScaleProjectiles;
 }
 
+DreamPlayerReference getPlayerReference(DreamPlayer* p)
+{
+	DreamPlayerReference ret;
+	ret.mPlayer = p;
+	ret.mHelperIDInStore = p ? p->mHelperIDInStore : -1;
+	ret.mGeneration = isHelperStoreSlotUsed(ret.mHelperIDInStore) ? gPlayerDefinition.mHelperStore.mSlotGenerations[ret.mHelperIDInStore] : 0;
+	return ret;
+}
+
+DreamPlayer* getReferencedPlayer(const DreamPlayerReference& tReference)
+{
+	if (tReference.mHelperIDInStore == -1) return tReference.mPlayer;
+	if (!isHelperStoreSlotUsed(tReference.mHelperIDInStore)) return NULL;
+	if (gPlayerDefinition.mHelperStore.mSlotGenerations[tReference.mHelperIDInStore] != tReference.mGeneration) return NULL;
+	return tReference.mPlayer;
+}
+
+int isPlayerReferenceTo(const DreamPlayerReference& tReference, DreamPlayer* p)
+{
+	return p && getReferencedPlayer(tReference) == p;
+}
+
 DreamPlayer * clonePlayerAsHelper(DreamPlayer* p)
 {
-	int helperIDInStore = stl_int_map_get_id();
-	DreamPlayer* helper = &gPlayerDefinition.mHelperStore[helperIDInStore];
+	int helperIDInStore = allocateHelperStoreSlot();
+	DreamPlayer* helper = getHelperStoreSlot(helperIDInStore);
 	*helper = *p;
 	helper->mHelperIDInStore = helperIDInStore;
+	helper->mVariables = getHelperStoreSlotVariables(helperIDInStore);
+	*helper->mVariables = *p->mVariables;
 
 	resetHelperState(helper);
 	setPlayerExternalDependencies(helper);
@@ -4464,8 +4589,8 @@ static void destroyGeneralPlayer(DreamPlayer* p) {
 	removePlayerAfterImage(p);
 	removeMugenAnimation(p->mAnimationElement);
 	removeMugenAnimation(p->mShadow.mAnimationElement);
-	removeMugenAnimation(p->mReflection.mAnimationElement);
-	removeMugenText(p->mDebug.mCollisionTextID);
+	if (p->mReflection.mAnimationElement) removeMugenAnimation(p->mReflection.mAnimationElement);
+	if (p->mDebug.mCollisionTextID != -1) removeMugenText(p->mDebug.mCollisionTextID);
 	removeFromPhysicsHandler(p->mPhysicsElement);
 	p->mIsDestroyed = 1;
 }
@@ -4520,9 +4645,9 @@ static void addProjectileToRoot(DreamPlayer* tPlayer, DreamPlayer* tProjectile)
 
 DreamPlayer * createNewProjectileFromPlayer(DreamPlayer* p)
 {
-	int helperIDInStore = stl_int_map_get_id();
-	DreamPlayer* helper = &gPlayerDefinition.mHelperStore[helperIDInStore];
-	*helper = *p;
+	int helperIDInStore = allocateHelperStoreSlot();
+	DreamPlayer* helper = getHelperStoreSlot(helperIDInStore);
+	*helper = *p; // keeps the owner's variable block, projectiles never run their own state machine
 	helper->mHelperIDInStore = helperIDInStore;
 
 	resetHelperState(helper);
@@ -4537,8 +4662,6 @@ DreamPlayer * createNewProjectileFromPlayer(DreamPlayer* p)
 	setPlayerIsFacingRight(helper, getPlayerIsFacingRight(p));
 	helper->mParent = p;
 	helper->mIsProjectile = 1;
-	assert(!stl_set_contains(gPlayerDefinition.mAllProjectiles, helper));
-	gPlayerDefinition.mAllProjectiles.insert(helper);
 
 	return helper;
 }
@@ -4551,9 +4674,7 @@ static void removeProjectileFromPlayer(DreamPlayer* p) {
 void removeProjectile(DreamPlayer* p) {
 	assert(p->mIsProjectile);
 	assert(p->mProjectileID != -1);
-	const auto eraseAmount = gPlayerDefinition.mAllProjectiles.erase(p);
-	(void)eraseAmount;
-	assert(eraseAmount);
+	assert(isActiveProjectile(p));
 	removeAdditionalProjectileData(p);
 	removeProjectileFromPlayer(p);
 	unloadHelperStateWithoutFreeingOwnedHelpersAndProjectile(p);
@@ -4604,7 +4725,7 @@ void setPlayerDrawAngleValue(DreamPlayer* p, double tAngle)
 
 static int isHelperBoundToPlayer(DreamPlayer* tHelper, DreamPlayer* tTestBind) {
 	if (!tHelper->mIsBound) return 0;
-	return tHelper->mBoundTarget == tTestBind;
+	return isPlayerReferenceTo(tHelper->mBoundTarget, tTestBind);
 }
 
 static void bindHelperToPlayer(DreamPlayer* tHelper, DreamPlayer* tBind, int tTime, int tFacing, const Vector2D& tOffsetCameraSpace, DreamPlayerBindPositionType tType) {
@@ -4615,7 +4736,7 @@ static void bindHelperToPlayer(DreamPlayer* tHelper, DreamPlayer* tBind, int tTi
 	tHelper->mBoundFaceSet = tFacing;
 	tHelper->mBoundOffsetCameraSpace = tOffsetCameraSpace;
 	tHelper->mBoundPositionType = tType;
-	tHelper->mBoundTarget = tBind;
+	tHelper->mBoundTarget = getPlayerReference(tBind);
 
 	if (isHelperBoundToPlayer(tBind, tHelper)) {
 		removePlayerBindingInternal(tBind);
@@ -4648,9 +4769,10 @@ void bindPlayerToTarget(DreamPlayer* p, int tTime, const Vector2D& tOffset, Drea
 {
 	const auto offsetCameraSpace = transformDreamCoordinatesVector2D(tOffset, tCoordinateP, getDreamMugenStageHandlerCameraCoordinateP());
 	for (const auto& targetPair : p->mActiveTargets) {
-		if (!isPlayer(targetPair.second)) continue;
+		const auto target = getReferencedPlayer(targetPair.second);
+		if (!isPlayer(target)) continue;
 		if (tID == -1 || tID == targetPair.first) {
-			bindHelperToPlayer(p, targetPair.second, tTime + 1, 0, offsetCameraSpace, tBindPositionType);
+			bindHelperToPlayer(p, target, tTime + 1, 0, offsetCameraSpace, tBindPositionType);
 		}
 	}
 }
@@ -4664,9 +4786,10 @@ void bindPlayerTargetToPlayer(DreamPlayer* p, int tTime, const Vector2D& tOffset
 {
 	const auto offsetCameraSpace = transformDreamCoordinatesVector2D(tOffset, tCoordinateP, getDreamMugenStageHandlerCameraCoordinateP());
 	for (const auto& targetPair : p->mActiveTargets) {
-		if (!isPlayer(targetPair.second)) continue;
+		const auto target = getReferencedPlayer(targetPair.second);
+		if (!isPlayer(target)) continue;
 		if (tID == -1 || tID == targetPair.first) {
-			bindHelperToPlayer(targetPair.second, p, tTime + 1, 0, offsetCameraSpace, PLAYER_BIND_POSITION_TYPE_AXIS);
+			bindHelperToPlayer(target, p, tTime + 1, 0, offsetCameraSpace, PLAYER_BIND_POSITION_TYPE_AXIS);
 		}
 	}
 }
@@ -4674,9 +4797,10 @@ void bindPlayerTargetToPlayer(DreamPlayer* p, int tTime, const Vector2D& tOffset
 static void performOnPlayerTargetsWithID(DreamPlayer* p, int tID, const std::function<void(DreamPlayer*)>& tFunc)
 {
 	for (const auto& targetPair : p->mActiveTargets) {
-		if (!isPlayer(targetPair.second)) continue;
+		const auto target = getReferencedPlayer(targetPair.second);
+		if (!isPlayer(target)) continue;
 		if (tID == -1 || tID == targetPair.first) {
-			tFunc(targetPair.second);
+			tFunc(target);
 		}
 	}
 }
@@ -4857,7 +4981,7 @@ void setPlayerScreenBoundForever(DreamPlayer* p, int tIsBoundToScreen)
 }
 
 static void resetPlayerHitBySlotGeneral(DreamPlayer* p, int tSlot) {
-	p->mNotHitBy[tSlot].mFlag2.clear();
+	p->mNotHitBy[tSlot].mAttributeFlags = 0;
 	p->mNotHitBy[tSlot].mNow = 0;
 	p->mNotHitBy[tSlot].mIsActive = 1;
 }
@@ -4876,8 +5000,8 @@ void resetPlayerNotHitBy(DreamPlayer* p, int tSlot)
 
 void setPlayerNotHitByFlag1(DreamPlayer* p, int tSlot, const char* tFlag)
 {
-	p->mNotHitBy[tSlot].mFlag1 = std::string(tFlag);
-	turnStringLowercase(p->mNotHitBy[tSlot].mFlag1);
+	p->mNotHitBy[tSlot].mAttributeFlags &= ~uint32_t(MUGEN_HIT_DEF_ATTRIBUTE_STATE_TYPE_MASK);
+	p->mNotHitBy[tSlot].mAttributeFlags |= compileHitDefAttributeFlag1(tFlag);
 }
 
 void addPlayerNotHitByFlag2(DreamPlayer* p, int tSlot, const char* tFlag)
@@ -4887,9 +5011,8 @@ void addPlayerNotHitByFlag2(DreamPlayer* p, int tSlot, const char* tFlag)
 		logErrorFormat("Unable to parse nothitby flag %s. Ignoring.", tFlag);
 		return;
 	}
-	turnStringLowercase(nFlag);
 
-	p->mNotHitBy[tSlot].mFlag2.push_back(nFlag);
+	p->mNotHitBy[tSlot].mAttributeFlags |= compileHitDefAttributeFlag2(nFlag);
 }
 
 void setPlayerNotHitByTime(DreamPlayer* p, int tSlot, int tTime)
@@ -5040,13 +5163,13 @@ int isPlayer(DreamPlayer* p)
 
 int isValidPlayerOrProjectile(DreamPlayer* p)
 {
-	return list_contains(&gPlayerDefinition.mAllPlayers, p) || stl_set_contains(gPlayerDefinition.mAllProjectiles, p);
+	return list_contains(&gPlayerDefinition.mAllPlayers, p) || isActiveProjectile(p);
 }
 
 int isGeneralPlayer(DreamPlayer* p)
 {
 	if (!p) return 0;
-	if ((isPlayerHelper(p) || isPlayerProjectile(p)) && !stl_map_contains(gPlayerDefinition.mHelperStore, p->mHelperIDInStore)) return 0;
+	if ((isPlayerHelper(p) || isPlayerProjectile(p)) && !isHelperStoreSlotUsed(p->mHelperIDInStore)) return 0;
 	return !isPlayerDestroyed(p);
 }
 
@@ -5063,7 +5186,10 @@ static void setPlayerCollisionDebugRecursiveCB(void* tCaller, void* tData) {
 	DreamPlayer* p = (DreamPlayer*)tData;
 	setMugenAnimationCollisionDebug(p->mAnimationElement, gPlayerDefinition.mIsCollisionDebugActive);
 
-	if (!gPlayerDefinition.mIsCollisionDebugActive) {
+	if (gPlayerDefinition.mIsCollisionDebugActive) {
+		loadPlayerDebugText(p);
+	}
+	else if (p->mDebug.mCollisionTextID != -1) {
 		char text[3];
 		text[0] = '\0';
 		changeMugenText(p->mDebug.mCollisionTextID, text);
@@ -5108,7 +5234,7 @@ static void setSinglePlayerSpeed(DreamPlayer* p, double tSpeed) {
 	p->mTimeDilatation = tSpeed;
 	setMugenAnimationSpeed(p->mAnimationElement, tSpeed);
 	setMugenAnimationSpeed(p->mShadow.mAnimationElement, tSpeed);
-	setMugenAnimationSpeed(p->mReflection.mAnimationElement, tSpeed);
+	if (p->mReflection.mAnimationElement) setMugenAnimationSpeed(p->mReflection.mAnimationElement, tSpeed);
 	setHandledPhysicsSpeed(p->mPhysicsElement, tSpeed);
 	setDreamHandledStateMachineSpeed(p->mRegisteredStateMachine, tSpeed);
 }
@@ -5128,7 +5254,7 @@ void setPlayersSpeed(double tSpeed)
 	SetPlayerSpeedCaller caller;
 	caller.mSpeed = tSpeed;
 	list_map(&gPlayerDefinition.mAllPlayers, setSinglePlayerSpeedCBOld, &caller);
-	stl_set_map(gPlayerDefinition.mAllProjectiles, setSinglePlayerSpeedCB, &caller);
+	mapActiveProjectiles(setSinglePlayerSpeedCBOld, &caller);
 }
 
 typedef struct {
@@ -101,6 +101,13 @@ typedef struct {
 
 } DreamPlayerDebugData;
 
+typedef struct {
+	int mVars[100];
+	int mSystemVars[100];
+	double mFloatVars[100];
+	double mSystemFloatVars[100];
+} DreamPlayerVariables;
+
 struct DreamPlayer {
 	DreamPlayerHeader* mHeader;
 	DreamMugenConstantsSizeData mCustomSizeData;
@@ -117,9 +124,8 @@ struct DreamPlayer {
 	int mProjectileDataID;
 
 	List mHelpers; // contains DreamPlayer
-	std::list<PlayerHitData> mReceivedHitData;
-	std::set<DreamPlayer*> mReceivedReversalDefPlayers;
-	std::set<std::pair<int, DreamPlayer*>> mActiveTargets;
+	std::vector<DreamPlayerReference> mReceivedReversalDefPlayers; // rarely filled, empty vectors do not allocate
+	std::set<std::pair<int, DreamPlayerReference>> mActiveTargets;
 	DreamPlayer* mParent;
 	int mHelperIDInParent;
 	int mHelperIDInRoot;
@@ -135,10 +141,7 @@ struct DreamPlayer {
 
 	int mAILevel;
 
-	int mVars[100];
-	int mSystemVars[100];
-	double mFloatVars[100];
-	double mSystemFloatVars[100];
+	DreamPlayerVariables* mVariables; // projectiles carry no block of their own and point at their owner's
 
 	int mCommandID;
 	RegisteredMugenStateMachine* mRegisteredStateMachine;
@@ -240,7 +243,7 @@ struct DreamPlayer {
 	int mBoundFaceSet;
 	Position2D mBoundOffsetCameraSpace;
 	DreamPlayerBindPositionType mBoundPositionType;
-	DreamPlayer* mBoundTarget;
+	DreamPlayerReference mBoundTarget;
 	int mBoundID;
 
 	List mBoundHelpers;
@@ -300,6 +303,7 @@ void setPlayerDefinitionPath(int i, const char* tDefinitionPath);
 void getPlayerDefinitionPath(char* tDst, int i);
 void setPlayerPreferredPalette(int i, int tPalette);
 void setPlayerPreferredPaletteRandom(int i);
+int getPlayerPreferredPalette(int i);
 
 DreamPlayer* getRootPlayer(int i);
 DreamPlayer* getPlayerRoot(DreamPlayer* p);
@@ -697,6 +701,9 @@ double getPlayerToCameraScale(DreamPlayer* p);
 int getPlayerDoesScaleProjectiles(DreamPlayer* p);
 void setPlayerDoesScaleProjectiles(DreamPlayer* p, int tDoesScaleProjectiles);
 
+DreamPlayerReference getPlayerReference(DreamPlayer* p);
+DreamPlayer* getReferencedPlayer(const DreamPlayerReference& tReference); // NULL once the helper or projectile has left its store slot
+int isPlayerReferenceTo(const DreamPlayerReference& tReference, DreamPlayer* p);
 DreamPlayer* clonePlayerAsHelper(DreamPlayer* p);
 int destroyPlayer(DreamPlayer* tPlayer);
 int getPlayerID(DreamPlayer* p);
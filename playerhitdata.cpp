@@ -1,6 +1,7 @@
 #include "playerhitdata.h"
 
 #include <assert.h>
+#include <ctype.h>
 
 #include <prism/datastructures.h>
 #include <prism/log.h>
@@ -36,10 +37,10 @@ void updatePlayerHitData(DreamPlayer* tPlayer)
 void initPlayerHitData(DreamPlayer* tPlayer)
 {
 	tPlayer->mPassiveHitData.mIsActive = 0;
-	tPlayer->mPassiveHitData.mPlayer = tPlayer;
+	tPlayer->mPassiveHitData.mPlayer = getPlayerReference(tPlayer);
 
 	tPlayer->mActiveHitData.mIsActive = 0;
-	tPlayer->mActiveHitData.mPlayer = tPlayer;
+	tPlayer->mActiveHitData.mPlayer = getPlayerReference(tPlayer);
 
 	int i;
 	for (i = 0; i < 8; i++) {
@@ -69,10 +70,43 @@ void copyHitDataToActive(DreamPlayer* tPlayer, void * tHitData)
 	*active = *passive;
 }
 
+void clearPlayerHitEvents(PlayerHitEvents* tEvents)
+{
+	tEvents->mAmount = 0;
+}
+
+int addPlayerHitEvent(PlayerHitEvents* tEvents, DreamPlayer* tReceiver, DreamPlayer* tAttacker, PlayerHitData* tHitData, int tOrder)
+{
+	if (tEvents->mAmount >= PLAYER_HIT_EVENT_CAPACITY) {
+		logWarningFormat("Unable to add hit event, %d hits received this tick. Ignoring.", tEvents->mAmount);
+		return 0;
+	}
+
+	int i = tEvents->mAmount;
+	for (; i > 0 && tEvents->mEvents[i - 1].mOrder > tOrder; i--) {
+		tEvents->mEvents[i] = tEvents->mEvents[i - 1];
+	}
+	PlayerHitEvent& e = tEvents->mEvents[i];
+	e.mReceiver = tReceiver;
+	e.mAttacker = tAttacker;
+	e.mHitData = tHitData;
+	e.mOrder = tOrder;
+	tEvents->mAmount++;
+	return 1;
+}
+
+void copyHitEventDataToActive(DreamPlayer* tPlayer, const PlayerHitEvent& tEvent)
+{
+	setProfilingSectionMarkerCurrentFunction();
+	PlayerHitData* active = &tPlayer->mActiveHitData;
+	*active = *tEvent.mHitData;
+	active->mIsActive = 1; // cleared on the attacker's data when received, or by the attacker's own state change in a trade
+}
+
 int isReceivedHitDataActive(void* tHitData)
 {
 	PlayerHitData* passive = (PlayerHitData*)tHitData;
-	return passive->mIsActive && isGeneralPlayer(passive->mPlayer);
+	return passive->mIsActive && isGeneralPlayer(getReferencedPlayer(passive->mPlayer));
 }
 
 int isHitDataActive(DreamPlayer* tPlayer)
@@ -138,14 +172,14 @@ DreamPlayer* getReceivedHitDataPlayer(void * tHitData)
 {
 	PlayerHitData* passive = (PlayerHitData*)tHitData;
 
-	return passive->mPlayer;
+	return getReferencedPlayer(passive->mPlayer);
 }
 
 DreamPlayer* getActiveHitDataPlayer(DreamPlayer* tPlayer) 
 {
 	assert(isGeneralPlayer(tPlayer));
 	PlayerHitData* e = &tPlayer->mActiveHitData;
-	return e->mPlayer;
+	return getReferencedPlayer(e->mPlayer); // NULL once the attacking helper or projectile is gone
 }
 
 DreamMugenStateType getHitDataType(DreamPlayer* tPlayer)
@@ -208,23 +242,21 @@ void setHitDataHitFlag(DreamPlayer* tPlayer, const char * tFlag)
 {
 	assert(isGeneralPlayer(tPlayer));
 	PlayerHitData* e = &tPlayer->mPassiveHitData;
-	assert(strlen(tFlag) < sizeof e->mHitFlag);
-	strcpy(e->mHitFlag, tFlag);
+	e->mHitFlagFlags = compileMugenHitFlags(tFlag);
 }
 
-char* getActiveHitDataGuardFlag(DreamPlayer* tPlayer)
+uint32_t getActiveHitDataGuardFlagFlags(DreamPlayer* tPlayer)
 {
 	assert(isGeneralPlayer(tPlayer));
 	PlayerHitData* e = &tPlayer->mActiveHitData;
-	return e->mGuardFlag;
+	return e->mGuardFlagFlags;
 }
 
 void setHitDataGuardFlag(DreamPlayer* tPlayer, const char * tFlag)
 {
 	assert(isGeneralPlayer(tPlayer));
 	PlayerHitData* e = &tPlayer->mPassiveHitData;
-	assert(strlen(tFlag) < sizeof e->mGuardFlag);
-	strcpy(e->mGuardFlag, tFlag);
+	e->mGuardFlagFlags = compileMugenHitFlags(tFlag);
 }
 
 MugenAffectTeam getHitDataAffectTeam(DreamPlayer* tPlayer)
@@ -1691,7 +1723,7 @@ void setHitDataReversalDefActive(DreamPlayer* tPlayer)
 {
 	assert(isGeneralPlayer(tPlayer));
 	PlayerHitData* e = &tPlayer->mPassiveHitData;
-	e->mReversalDef.mReversalAttribute.mFlag2.clear();
+	e->mReversalDef.mReversalAttribute.mAttributeFlags = 0;
 	e->mReversalDef.mReversalAttribute.mIsActive = 1;
 	e->mReversalDef.mReversalAttribute.mIsHitBy = 1;
 	e->mReversalDef.mIsActive = 1;
@@ -1708,7 +1740,8 @@ void setHitDataReversalDefFlag1(DreamPlayer* tPlayer, const char* tFlag)
 {
 	assert(isGeneralPlayer(tPlayer));
 	PlayerHitData* e = &tPlayer->mPassiveHitData;
-	e->mReversalDef.mReversalAttribute.mFlag1 = copyOverCleanHitDefAttributeFlag(tFlag);
+	e->mReversalDef.mReversalAttribute.mAttributeFlags &= ~uint32_t(MUGEN_HIT_DEF_ATTRIBUTE_STATE_TYPE_MASK);
+	e->mReversalDef.mReversalAttribute.mAttributeFlags |= compileHitDefAttributeFlag1(copyOverCleanHitDefAttributeFlag(tFlag));
 }
 
 void addHitDataReversalDefFlag2(DreamPlayer* tPlayer, const char* tFlag)
@@ -1721,9 +1754,8 @@ void addHitDataReversalDefFlag2(DreamPlayer* tPlayer, const char* tFlag)
 		logWarningFormat("Unparseable reversal definition flag: %s. Ignore.", nFlag.c_str());
 		return;
 	}
-	turnStringLowercase(nFlag);
 
-	e->mReversalDef.mReversalAttribute.mFlag2.push_back(nFlag);
+	e->mReversalDef.mReversalAttribute.mAttributeFlags |= compileHitDefAttributeFlag2(nFlag);
 }
 
 int getReversalDefPlayer1PauseTime(DreamPlayer* tPlayer)
@@ -1949,3 +1981,145 @@ MugenAttackClassFlags convertMugenAttackClassToFlag(MugenAttackClass tAttackClas
 		return MUGEN_ATTACK_CLASS_NORMAL_FLAG;
 	}
 }
+
+uint32_t getHitDataAttributeFlags(DreamPlayer* tPlayer)
+{
+	assert(isGeneralPlayer(tPlayer));
+	PlayerHitData* e = &tPlayer->mPassiveHitData;
+	const auto attackIndex = uint32_t(e->mAttackClass) * 3 + uint32_t(e->mAttackType);
+	return uint32_t(convertDreamMugenStateTypeToFlag(e->mType)) | (1u << (MUGEN_HIT_DEF_ATTRIBUTE_ATTACK_SHIFT + attackIndex));
+}
+
+uint32_t compileHitDefAttributeFlag1(const std::string& tFlag1)
+{
+	uint32_t ret = 0;
+	for (const auto c : tFlag1) {
+		const auto lower = tolower(c);
+		if (lower == 's') ret |= MUGEN_STATE_TYPE_STANDING_FLAG;
+		else if (lower == 'c') ret |= MUGEN_STATE_TYPE_CROUCHING_FLAG;
+		else if (lower == 'a') ret |= MUGEN_STATE_TYPE_AIR_FLAG;
+	}
+	return ret;
+}
+
+static uint32_t compileHitDefAttributeAttackClassMask(char tClass) {
+	switch (tolower(tClass)) {
+	case 'n':
+		return 1u << (MUGEN_ATTACK_CLASS_NORMAL * 3);
+	case 's':
+		return 1u << (MUGEN_ATTACK_CLASS_SPECIAL * 3);
+	case 'h':
+		return 1u << (MUGEN_ATTACK_CLASS_HYPER * 3);
+	case 'a':
+		return (1u << (MUGEN_ATTACK_CLASS_NORMAL * 3)) | (1u << (MUGEN_ATTACK_CLASS_SPECIAL * 3)) | (1u << (MUGEN_ATTACK_CLASS_HYPER * 3));
+	default:
+		return 0;
+	}
+}
+
+static int compileHitDefAttributeAttackTypeShift(char tType) {
+	switch (tolower(tType)) {
+	case 'a':
+		return MUGEN_ATTACK_TYPE_ATTACK;
+	case 't':
+		return MUGEN_ATTACK_TYPE_THROW;
+	case 'p':
+		return MUGEN_ATTACK_TYPE_PROJECTILE;
+	default:
+		return -1;
+	}
+}
+
+uint32_t compileHitDefAttributeFlag2(const std::string& tFlag2)
+{
+	if (tFlag2.size() != 2) {
+		logWarningFormat("Unable to compile hitdef attribute flag %s, invalid size.", tFlag2.c_str());
+		return MUGEN_HIT_DEF_ATTRIBUTE_HAS_ATTACK_FLAG;
+	}
+
+	const auto classMask = compileHitDefAttributeAttackClassMask(tFlag2[0]);
+	const auto typeShift = compileHitDefAttributeAttackTypeShift(tFlag2[1]);
+	if (!classMask || typeShift < 0) {
+		logWarningFormat("Unable to compile hitdef attribute flag %s, unrecognized class or type.", tFlag2.c_str());
+		return MUGEN_HIT_DEF_ATTRIBUTE_HAS_ATTACK_FLAG;
+	}
+
+	return ((classMask << typeShift) << MUGEN_HIT_DEF_ATTRIBUTE_ATTACK_SHIFT) | MUGEN_HIT_DEF_ATTRIBUTE_HAS_ATTACK_FLAG;
+}
+
+uint32_t compileHitDefAttributeString(const std::string& tAttributeString)
+{
+	auto commaPos = tAttributeString.find(',');
+	uint32_t ret = compileHitDefAttributeFlag1(copyOverCleanHitDefAttributeFlag(tAttributeString.substr(0, commaPos).c_str()));
+	while (commaPos != std::string::npos) {
+		const auto startPos = commaPos + 1;
+		commaPos = tAttributeString.find(',', startPos);
+		const auto flag2 = copyOverCleanHitDefAttributeFlag(tAttributeString.substr(startPos, commaPos == std::string::npos ? std::string::npos : commaPos - startPos).c_str());
+		ret |= compileHitDefAttributeFlag2(flag2);
+	}
+	return ret;
+}
+
+int isHitDefAttributeMatching(uint32_t tAttributeFlags, uint32_t tHitDataAttributeFlags)
+{
+	const auto matches = tAttributeFlags & tHitDataAttributeFlags;
+	if (!(matches & MUGEN_HIT_DEF_ATTRIBUTE_STATE_TYPE_MASK)) return 0;
+	if (!(tAttributeFlags & MUGEN_HIT_DEF_ATTRIBUTE_HAS_ATTACK_FLAG)) return 1;
+	return (matches & MUGEN_HIT_DEF_ATTRIBUTE_ATTACK_MASK) != 0;
+}
+
+uint32_t compileMugenHitFlags(const char* tFlag)
+{
+	uint32_t ret = MUGEN_HIT_FLAG_NO_FLAG;
+	for (; *tFlag; tFlag++) {
+		switch (tolower(*tFlag)) {
+		case 'h':
+			ret |= MUGEN_HIT_FLAG_HIGH_FLAG;
+			break;
+		case 'l':
+			ret |= MUGEN_HIT_FLAG_LOW_FLAG;
+			break;
+		case 'm':
+			ret |= MUGEN_HIT_FLAG_HIGH_FLAG | MUGEN_HIT_FLAG_LOW_FLAG;
+			break;
+		case 'a':
+			ret |= MUGEN_HIT_FLAG_AIR_FLAG;
+			break;
+		case 'f':
+			ret |= MUGEN_HIT_FLAG_FALL_FLAG;
+			break;
+		case 'd':
+			ret |= MUGEN_HIT_FLAG_DOWN_FLAG;
+			break;
+		case '+':
+			ret |= MUGEN_HIT_FLAG_GET_HIT_STATE_FLAG;
+			break;
+		case '-':
+			ret |= MUGEN_HIT_FLAG_NOT_GET_HIT_STATE_FLAG;
+			break;
+		default:
+			break;
+		}
+	}
+	return ret;
+}
+
+int isMugenHitFlagMatching(uint32_t tHitFlagFlags, DreamMugenStateType tStateType, int tIsGettingHit, int tIsFalling, int tIsGuarding)
+{
+	if ((tHitFlagFlags & MUGEN_HIT_FLAG_GET_HIT_STATE_FLAG) && !tIsGettingHit) return 0;
+	if ((tHitFlagFlags & MUGEN_HIT_FLAG_NOT_GET_HIT_STATE_FLAG) && tIsGettingHit) return 0;
+	if (tIsGuarding) return 1; // guarding is decided by guardflag
+
+	if (tStateType == MUGEN_STATE_TYPE_STANDING) {
+		return !!(tHitFlagFlags & MUGEN_HIT_FLAG_HIGH_FLAG);
+	}
+	else if (tStateType == MUGEN_STATE_TYPE_CROUCHING) {
+		return !!(tHitFlagFlags & MUGEN_HIT_FLAG_LOW_FLAG);
+	}
+	else if (tStateType == MUGEN_STATE_TYPE_AIR) {
+		return !!(tHitFlagFlags & (tIsFalling ? MUGEN_HIT_FLAG_FALL_FLAG : MUGEN_HIT_FLAG_AIR_FLAG));
+	}
+	else {
+		return !!(tHitFlagFlags & MUGEN_HIT_FLAG_DOWN_FLAG);
+	}
+}
@@ -9,6 +9,17 @@ using namespace prism;
 
 struct DreamPlayer;
 
+typedef struct {
+	DreamPlayer* mPlayer;
+	int mHelperIDInStore; // -1 for root players, which are never destroyed
+	int mGeneration; // of the store slot, bumped whenever the slot is freed
+} DreamPlayerReference;
+
+inline bool operator<(const DreamPlayerReference& tLeft, const DreamPlayerReference& tRight) {
+	if (tLeft.mPlayer != tRight.mPlayer) return tLeft.mPlayer < tRight.mPlayer;
+	return tLeft.mGeneration < tRight.mGeneration;
+}
+
 typedef enum {
 	MUGEN_ATTACK_CLASS_NORMAL,
 	MUGEN_ATTACK_CLASS_SPECIAL,
@@ -28,6 +39,24 @@ typedef enum {
 	MUGEN_ATTACK_TYPE_PROJECTILE,
 } MugenAttackType;
 
+enum MugenHitDefAttributeFlags : uint32_t {
+	MUGEN_HIT_DEF_ATTRIBUTE_STATE_TYPE_MASK = MUGEN_STATE_TYPE_ALL_FLAG,
+	MUGEN_HIT_DEF_ATTRIBUTE_ATTACK_SHIFT = 3,
+	MUGEN_HIT_DEF_ATTRIBUTE_ATTACK_MASK = (0x1FF << MUGEN_HIT_DEF_ATTRIBUTE_ATTACK_SHIFT),
+	MUGEN_HIT_DEF_ATTRIBUTE_HAS_ATTACK_FLAG = (1 << 12),
+};
+
+enum MugenHitFlagFlags : uint32_t {
+	MUGEN_HIT_FLAG_NO_FLAG = 0,
+	MUGEN_HIT_FLAG_HIGH_FLAG = (1 << 0),
+	MUGEN_HIT_FLAG_LOW_FLAG = (1 << 1),
+	MUGEN_HIT_FLAG_AIR_FLAG = (1 << 2),
+	MUGEN_HIT_FLAG_FALL_FLAG = (1 << 3),
+	MUGEN_HIT_FLAG_DOWN_FLAG = (1 << 4),
+	MUGEN_HIT_FLAG_GET_HIT_STATE_FLAG = (1 << 5),
+	MUGEN_HIT_FLAG_NOT_GET_HIT_STATE_FLAG = (1 << 6),
+};
+
 typedef enum {
 	MUGEN_ATTACK_HEIGHT_LOW,
 	MUGEN_ATTACK_HEIGHT_HIGH,
@@ -63,8 +92,7 @@ typedef enum {
 typedef struct {
 	int mIsActive;
 
-	std::string mFlag1;
-	std::vector<std::string> mFlag2;
+	uint32_t mAttributeFlags;
 
 	int mNow;
 	int mTime;
@@ -94,15 +122,15 @@ typedef struct {
 
 typedef struct {
 	int mIsActive;
-	DreamPlayer* mPlayer;
+	DreamPlayerReference mPlayer;
 	int mCoordinateP;
 
 	DreamMugenStateType mType;
 	MugenAttackClass mAttackClass;
 	MugenAttackType mAttackType;
 
-	char mHitFlag[10];
-	char mGuardFlag[10];
+	uint32_t mHitFlagFlags;
+	uint32_t mGuardFlagFlags;
 
 	MugenAffectTeam mAffectTeam;
 	MugenHitAnimationType mAnimationType;
@@ -253,6 +281,22 @@ typedef struct {
 	HitOverride mHitOverrides[8];
 } PlayerHitOverrides;
 
+#define PLAYER_HIT_EVENT_CAPACITY 256
+
+// a received hit waiting for the receiver's update; the attacker's passive hit data is read when the hit resolves
+typedef struct {
+	DreamPlayer* mReceiver;
+	DreamPlayer* mAttacker;
+	PlayerHitData* mHitData;
+	int mOrder;
+} PlayerHitEvent;
+
+// one tick of received hits, kept sorted by attacker order; receiving deactivates the attacker's hit data, so every attacker adds one event at most
+typedef struct {
+	PlayerHitEvent mEvents[PLAYER_HIT_EVENT_CAPACITY];
+	int mAmount;
+} PlayerHitEvents;
+
 void updatePlayerHitData(DreamPlayer* tPlayer);
 
 void initPlayerHitData(DreamPlayer* tPlayer);
@@ -261,6 +305,10 @@ void clearPlayerHitData(DreamPlayer* tPlayer);
 
 void copyHitDataToActive(DreamPlayer* tPlayer, void* tHitData);
 
+void clearPlayerHitEvents(PlayerHitEvents* tEvents);
+int addPlayerHitEvent(PlayerHitEvents* tEvents, DreamPlayer* tReceiver, DreamPlayer* tAttacker, PlayerHitData* tHitData, int tOrder);
+void copyHitEventDataToActive(DreamPlayer* tPlayer, const PlayerHitEvent& tEvent);
+
 int isReceivedHitDataActive(void* tHitData);
 int isHitDataActive(DreamPlayer* tPlayer);
 int isActiveHitDataActive(DreamPlayer* tPlayer);
@@ -285,7 +333,7 @@ MugenAttackType getActiveHitDataAttackType(DreamPlayer* tPlayer);
 void setHitDataAttackType(DreamPlayer* tPlayer, MugenAttackType tType);
 
 void setHitDataHitFlag(DreamPlayer* tPlayer, const char* tFlag);
-char* getActiveHitDataGuardFlag(DreamPlayer* tPlayer);
+uint32_t getActiveHitDataGuardFlagFlags(DreamPlayer* tPlayer);
 void setHitDataGuardFlag(DreamPlayer* tPlayer, const char* tFlag);
 MugenAffectTeam getHitDataAffectTeam(DreamPlayer* tPlayer);
 void setHitDataAffectTeam(DreamPlayer* tPlayer, MugenAffectTeam tAffectTeam);
@@ -550,4 +598,11 @@ int isIgnoredBecauseOfHitOverride(DreamPlayer* tPlayer, DreamPlayer* tOtherPlaye
 void getMatchingHitOverrideStateNoAndForceAir(DreamPlayer* tPlayer, DreamPlayer * tOtherPlayer, int* oStateNo, int* oDoesForceAir);
 
 std::string copyOverCleanHitDefAttributeFlag(const char* tSrc);
-MugenAttackClassFlags convertMugenAttackClassToFlag(MugenAttackClass tAttackClass);
\ No newline at end of file
+MugenAttackClassFlags convertMugenAttackClassToFlag(MugenAttackClass tAttackClass);
+uint32_t getHitDataAttributeFlags(DreamPlayer* tPlayer);
+uint32_t compileHitDefAttributeFlag1(const std::string& tFlag1);
+uint32_t compileHitDefAttributeFlag2(const std::string& tFlag2);
+uint32_t compileHitDefAttributeString(const std::string& tAttributeString);
+int isHitDefAttributeMatching(uint32_t tAttributeFlags, uint32_t tHitDataAttributeFlags);
+uint32_t compileMugenHitFlags(const char* tFlag);
+int isMugenHitFlagMatching(uint32_t tHitFlagFlags, DreamMugenStateType tStateType, int tIsGettingHit, int tIsFalling, int tIsGuarding);
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include <assert.h>
 #include <algorithm>
+#include <unordered_map>
+#include <vector>
 
 #include <prism/datastructures.h>
 #include <prism/math.h>
@@ -14,6 +16,8 @@ using namespace std;
 
 typedef struct {
 	DreamPlayer* mPlayer;
+	DreamPlayerReference mPlayerReference; // the store slot goes to the next helper or projectile once removed
+	int mIsActive;
 
 	int mID;
 	int mHitAnimation;
@@ -51,24 +55,43 @@ typedef struct {
 } Projectile;
 
 static struct {
-	IntMap mProjectileList;
+	vector<Projectile> mProjectiles; // indexed by mProjectileDataID, slots are reused
+	vector<int> mFreeProjectileIDs;
+	unordered_map<DreamPlayer*, int> mActiveProjectileIDs;
 } gProjectileData;
 
 static void loadProjectileHandler(void* tData) {
 	(void)tData;
 	setProfilingSectionMarkerCurrentFunction();
-	gProjectileData.mProjectileList = new_int_map();
+	gProjectileData.mProjectiles.clear();
+	gProjectileData.mFreeProjectileIDs.clear();
+	gProjectileData.mActiveProjectileIDs.clear();
 }
 
 static void unloadProjectileHandler(void* tData) {
 	(void)tData;
 	setProfilingSectionMarkerCurrentFunction();
-	delete_int_map(&gProjectileData.mProjectileList);
+	gProjectileData.mProjectiles.clear();
+	gProjectileData.mFreeProjectileIDs.clear();
+	gProjectileData.mActiveProjectileIDs.clear();
+}
+
+static int hasProjectileData(DreamPlayer* p) {
+	const auto id = p->mProjectileDataID;
+	if (id < 0 || id >= int(gProjectileData.mProjectiles.size())) return 0;
+	const auto& e = gProjectileData.mProjectiles[id];
+	return e.mIsActive && isPlayerReferenceTo(e.mPlayerReference, p);
+}
+
+static Projectile* getProjectileData(DreamPlayer* p) {
+	assert(hasProjectileData(p));
+	return &gProjectileData.mProjectiles[p->mProjectileDataID];
 }
 
 static void projectileRemoveAnimationFinishedCB(void* tCaller) {
-	Projectile* e = (Projectile*)tCaller;
-	e->mShouldBeRemoved = 1;
+	DreamPlayer* p = (DreamPlayer*)tCaller;
+	if (!hasProjectileData(p)) return;
+	getProjectileData(p)->mShouldBeRemoved = 1;
 }
 
 static int changeProjectileAnimation(Projectile* e, int tAnimationNumber, int tShouldBeRemoved = 1) {
@@ -83,7 +106,7 @@ static int changeProjectileAnimation(Projectile* e, int tAnimationNumber, int tS
 			return 1;
 		}
 		else {
-			setPlayerAnimationFinishedCallback(e->mPlayer, projectileRemoveAnimationFinishedCB, e);
+			setPlayerAnimationFinishedCallback(e->mPlayer, projectileRemoveAnimationFinishedCB, e->mPlayer);
 			setProjectileVelocity(e->mPlayer, e->mRemoveVelocity.x, e->mRemoveVelocity.y, getDreamMugenStageHandlerCameraCoordinateP());
 		}
 	}
@@ -144,9 +167,7 @@ static void updateProjectileShadow(Projectile* e) {
 	}
 }
 
-static void updateSingleProjectile(void* tCaller, void* tData) {
-	(void)tCaller;
-	Projectile* e = (Projectile*)tData;
+static void updateSingleProjectile(Projectile* e) {
 	if (e->mShouldBeRemoved) {
 		removeProjectile(e->mPlayer);
 		return;
@@ -168,7 +189,11 @@ static void updateSingleProjectile(void* tCaller, void* tData) {
 static void updateProjectileHandler(void* tData) {
 	(void)tData;
 	setProfilingSectionMarkerCurrentFunction();
-	int_map_map(&gProjectileData.mProjectileList, updateSingleProjectile, NULL);
+	for (size_t i = 0; i < gProjectileData.mProjectiles.size(); i++) {
+		auto& e = gProjectileData.mProjectiles[i];
+		if (!e.mIsActive) continue;
+		updateSingleProjectile(&e);
+	}
 }
 
 ActorBlueprint getProjectileHandler() {
@@ -176,26 +201,55 @@ ActorBlueprint getProjectileHandler() {
 };
 
 void addAdditionalProjectileData(DreamPlayer* tProjectile) {
-	Projectile* e = (Projectile*)allocMemory(sizeof(Projectile));
+	int id;
+	if (gProjectileData.mFreeProjectileIDs.empty()) {
+		id = int(gProjectileData.mProjectiles.size());
+		gProjectileData.mProjectiles.push_back(Projectile());
+	}
+	else {
+		id = gProjectileData.mFreeProjectileIDs.back();
+		gProjectileData.mFreeProjectileIDs.pop_back();
+		gProjectileData.mProjectiles[id] = Projectile();
+	}
+
+	Projectile* e = &gProjectileData.mProjectiles[id];
+	e->mIsActive = 1;
 	e->mNow = 1;
 	e->mHasChangedAnimationFinal = 0;
 	e->mShouldBeRemoved = 0;
 	e->mPlayer = tProjectile;
-	tProjectile->mProjectileDataID = int_map_push_back_owned(&gProjectileData.mProjectileList, e);
+	e->mPlayerReference = getPlayerReference(tProjectile);
+	tProjectile->mProjectileDataID = id;
+	gProjectileData.mActiveProjectileIDs[tProjectile] = id;
 }
 
 void removeAdditionalProjectileData(DreamPlayer* tProjectile) {
-	if (!int_map_contains(&gProjectileData.mProjectileList, tProjectile->mProjectileDataID)) {
+	if (!hasProjectileData(tProjectile)) {
 		logWarningFormat("Error trying to remove projectile data for player %d %d who has no projectile data.", tProjectile->mRootID, tProjectile->mID);
 		return;
 	}
-	int_map_remove(&gProjectileData.mProjectileList, tProjectile->mProjectileDataID);
+	gProjectileData.mProjectiles[tProjectile->mProjectileDataID].mIsActive = 0;
+	gProjectileData.mFreeProjectileIDs.push_back(tProjectile->mProjectileDataID);
+	gProjectileData.mActiveProjectileIDs.erase(tProjectile);
+}
+
+int isActiveProjectile(DreamPlayer* p)
+{
+	return gProjectileData.mActiveProjectileIDs.find(p) != gProjectileData.mActiveProjectileIDs.end();
+}
+
+void mapActiveProjectiles(void(*tFunc)(void* tCaller, void* tData), void* tCaller)
+{
+	for (size_t i = 0; i < gProjectileData.mProjectiles.size(); i++) {
+		const auto& e = gProjectileData.mProjectiles[i];
+		if (!e.mIsActive) continue;
+		tFunc(tCaller, e.mPlayer);
+	}
 }
 
 void handleProjectileHit(DreamPlayer* tProjectile, int tWasGuarded, int tWasCanceled)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, tProjectile->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, tProjectile->mProjectileDataID);
+	Projectile* e = getProjectileData(tProjectile);
 	e->mMissHitNow = 0;
 
 	DreamPlayer* owner = tProjectile->mParent;
@@ -218,15 +272,13 @@ void handleProjectileHit(DreamPlayer* tProjectile, int tWasGuarded, int tWasCanc
 
 void setProjectileID(DreamPlayer * tProjectile, int tID)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, tProjectile->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, tProjectile->mProjectileDataID);
+	Projectile* e = getProjectileData(tProjectile);
 	e->mID = tID;
 }
 
 int getProjectileID(DreamPlayer * tProjectile)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, tProjectile->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, tProjectile->mProjectileDataID);
+	Projectile* e = getProjectileData(tProjectile);
 	return e->mID;
 }
 
@@ -237,57 +289,49 @@ void setProjectileAnimation(DreamPlayer* p, int tAnimation)
 
 int getProjectileHitAnimation(DreamPlayer* p)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	return e->mHitAnimation;
 }
 
 void setProjectileHitAnimation(DreamPlayer* p, int tAnimation)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	e->mHitAnimation = tAnimation;
 }
 
 int getProjectileRemoveAnimation(DreamPlayer* p)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	return e->mRemoveAnimation;
 }
 
 void setProjectileRemoveAnimation(DreamPlayer* p, int tAnimation)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	e->mRemoveAnimation = tAnimation;
 }
 
 void setProjectileCancelAnimation(DreamPlayer* p, int tAnimation)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	e->mCancelAnimation = tAnimation;
 }
 
 void setProjectileScale(DreamPlayer* p, double tX, double tY)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	e->mScale = Vector2D(tX, tY);
 }
 
 void setProjectileRemoveAfterHit(DreamPlayer* p, int tValue)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	e->mRemoveAfterHit = tValue;
 }
 
 void setProjectileRemoveTime(DreamPlayer* p, int tTime)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	e->mRemoveTime = tTime;
 }
 
@@ -299,58 +343,50 @@ void setProjectileVelocity(DreamPlayer* p, double tX, double tY, int tCoordinate
 
 void setProjectileRemoveVelocity(DreamPlayer* p, double tX, double tY, int tCoordinateP)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	e->mRemoveVelocity = transformDreamCoordinatesVector(Vector3D(tX, tY, 0), tCoordinateP, getDreamMugenStageHandlerCameraCoordinateP());
 }
 
 void setProjectileAcceleration(DreamPlayer* p, double tX, double tY, int tCoordinateP)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	e->mAcceleration = transformDreamCoordinatesVector(Vector3D(tX, tY, 0), tCoordinateP, getDreamMugenStageHandlerCameraCoordinateP());
 }
 
 void setProjectileVelocityMultipliers(DreamPlayer* p, double tX, double tY)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	e->mVelocityMultipliers = Vector3D(tX, tY, 1);
 }
 
 void setProjectileHitAmountBeforeVanishing(DreamPlayer* p, int tHitAmount)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	e->mHitAmountBeforeVanishing = tHitAmount;
 }
 
 void setProjectilMisstime(DreamPlayer* p, int tMissTime)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	e->mMissTime = tMissTime;
 	e->mMissHitNow = e->mMissTime + 1;
 }
 
 int getProjectilePriority(DreamPlayer* p)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	return e->mPriority;
 }
 
 void setProjectilePriority(DreamPlayer* p, int tPriority)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	e->mPriority = tPriority;
 }
 
 void reduceProjectilePriorityAndResetHitData(DreamPlayer* p)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	e->mPriority--;
 	setHitDataActive(p);
 }
@@ -362,22 +398,19 @@ void setProjectileSpritePriority(DreamPlayer* p, int tSpritePriority)
 
 void setProjectileEdgeBound(DreamPlayer* p, int tEdgeBound, int tCoordinateP)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	e->mEdgeBound = transformDreamCoordinatesI(tEdgeBound, tCoordinateP, getDreamMugenStageHandlerCameraCoordinateP());
 }
 
 void setProjectileStageBound(DreamPlayer* p, int tStageBound, int tCoordinateP)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	e->mStageBound = transformDreamCoordinatesI(tStageBound, tCoordinateP, getDreamMugenStageHandlerCameraCoordinateP());
 }
 
 void setProjectileHeightBoundValues(DreamPlayer* p, int tLowerBound, int tUpperBound, int tCoordinateP)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	e->mLowerBound = transformDreamCoordinatesI(tLowerBound, tCoordinateP, getDreamMugenStageHandlerCameraCoordinateP());
 	e->mUpperBound = transformDreamCoordinatesI(tUpperBound, tCoordinateP, getDreamMugenStageHandlerCameraCoordinateP());
 }
@@ -389,43 +422,38 @@ void setProjectilePosition(DreamPlayer* p, const Position2D& tPosition, int tCoo
 
 void setProjectileShadow(DreamPlayer* p, int tShadow)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	e->mShadow = tShadow;
 	updateProjectileShadow(e);
 }
 
 void setProjectileSuperMoveTime(DreamPlayer* p, int tSuperMoveTime)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	setPlayerSuperMoveTime(e->mPlayer, tSuperMoveTime);
 }
 
 void setProjectilePauseMoveTime(DreamPlayer* p, int tPauseMoveTime)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	setPlayerPauseMoveTime(e->mPlayer, tPauseMoveTime);
 }
 
 void setProjectileHasOwnPalette(DreamPlayer* p, int tValue)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
+	assert(hasProjectileData(p));
 	setPlayerHasOwnPalette(p, tValue);
 }
 
 void setProjectileRemapPalette(DreamPlayer* p, int tGroup, int tItem)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	e->mRemapPaletteGroup = tGroup; // not used in Dolmexica Infinite
 	e->mRemapPaletteItem = tItem;
 }
 
 int canProjectileHit(DreamPlayer* p)
 {
-	assert(int_map_contains(&gProjectileData.mProjectileList, p->mProjectileDataID));
-	Projectile* e = (Projectile*)int_map_get(&gProjectileData.mProjectileList, p->mProjectileDataID);
+	Projectile* e = getProjectileData(p);
 	return e->mMissHitNow >= e->mMissTime;
 }
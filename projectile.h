@@ -10,6 +10,8 @@ ActorBlueprint getProjectileHandler();
 
 void addAdditionalProjectileData(DreamPlayer* tProjectile);
 void removeAdditionalProjectileData(DreamPlayer* tProjectile);
+int isActiveProjectile(DreamPlayer* p);
+void mapActiveProjectiles(void(*tFunc)(void* tCaller, void* tData), void* tCaller);
 void handleProjectileHit(DreamPlayer* tProjectile, int tWasGuarded, int tWasCanceled);
 
 void setProjectileID(DreamPlayer* p, int tID);
@@ -0,0 +1,262 @@
+#include "rosterindex.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <map>
+#include <vector>
+
+#include <prism/file.h>
+#include <prism/log.h>
+#include <prism/mugendefreader.h>
+
+#include "config.h"
+
+using namespace prism;
+
+#define ROSTER_INDEX_VERSION 3
+#define ROSTER_INDEX_PORTRAITS_SUFFIX ".portraits.preloaded"
+
+typedef struct {
+	uint32_t mFileSize;
+	uint32_t mModificationTime; // only hashed again when size or time differ
+	uint32_t mContentHash; // modification times do not survive read-only discs and fresh checkouts
+	int mIsInRoster; // requested since the last loadRosterIndex, not saved
+	RosterIndexEntry mEntry;
+} RosterIndexRecord;
+
+static struct {
+	int mIsLoaded;
+	int mHasChanged;
+	int mRequestAmount; // since the last loadRosterIndex
+	std::map<std::string, RosterIndexRecord> mRecords; // keyed by definition path, kept across screens
+} gRosterIndexData;
+
+static std::string getRosterIndexPath() {
+	return getDolmexicaAssetFolder() + "data/roster.preloaded";
+}
+
+static int getRosterIndexFileStat(const char* tPath, uint32_t* oFileSize, uint32_t* oModificationTime) {
+	char fullPath[1024];
+	getFullPath(fullPath, tPath);
+	struct stat fileStatus;
+	if (stat(fullPath, &fileStatus)) return 0;
+
+	*oFileSize = uint32_t(fileStatus.st_size);
+	*oModificationTime = uint32_t(fileStatus.st_mtime);
+	return 1;
+}
+
+static uint32_t getRosterIndexContentHash(const char* tPath) {
+	auto b = fileToBuffer(tPath);
+	const auto p = (const unsigned char*)getBufferPointer(b);
+	uint32_t hash = 2166136261u; // FNV-1a
+	for (uint32_t i = 0; i < b.mLength; i++) {
+		hash = (hash ^ p[i]) * 16777619u;
+	}
+	freeBuffer(b);
+	return hash;
+}
+
+static void appendRosterIndexString(Buffer* b, const std::string& tString) {
+	appendBufferUint32(b, uint32_t(tString.size()));
+	appendBufferString(b, tString.c_str(), int(tString.size()));
+}
+
+static int readRosterIndexValue(void* oValue, BufferPointer* p, BufferPointer tEnd, uint32_t tSize) {
+	if (uint32_t(tEnd - *p) < tSize) return 0;
+	readFromBufferPointer(oValue, p, tSize);
+	return 1;
+}
+
+static int readRosterIndexString(std::string* oString, BufferPointer* p, BufferPointer tEnd) {
+	uint32_t len;
+	if (!readRosterIndexValue(&len, p, tEnd, sizeof(uint32_t))) return 0;
+	if (uint32_t(tEnd - *p) < len) return 0;
+	oString->assign(*p, len);
+	*p += len;
+	return 1;
+}
+
+static int readRosterIndexRecord(BufferPointer* p, BufferPointer tEnd) {
+	std::string path;
+	RosterIndexRecord record;
+	if (!readRosterIndexString(&path, p, tEnd)) return 0;
+	if (!readRosterIndexValue(&record.mFileSize, p, tEnd, sizeof(uint32_t))) return 0;
+	if (!readRosterIndexValue(&record.mModificationTime, p, tEnd, sizeof(uint32_t))) return 0;
+	if (!readRosterIndexValue(&record.mContentHash, p, tEnd, sizeof(uint32_t))) return 0;
+	if (!readRosterIndexString(&record.mEntry.mDisplayName, p, tEnd)) return 0;
+	if (!readRosterIndexString(&record.mEntry.mName, p, tEnd)) return 0;
+	if (!readRosterIndexString(&record.mEntry.mAuthorName, p, tEnd)) return 0;
+	if (!readRosterIndexString(&record.mEntry.mVersionDate, p, tEnd)) return 0;
+	if (!readRosterIndexString(&record.mEntry.mSpritePath, p, tEnd)) return 0;
+	if (!readRosterIndexValue(&record.mEntry.mHasPalettePath, p, tEnd, sizeof(int32_t))) return 0;
+	if (!readRosterIndexString(&record.mEntry.mPalettePath, p, tEnd)) return 0;
+	record.mIsInRoster = 0;
+	gRosterIndexData.mRecords[path] = record;
+	return 1;
+}
+
+static void writeRosterIndexRecord(Buffer* b, const std::string& tPath, const RosterIndexRecord& tRecord) {
+	appendRosterIndexString(b, tPath);
+	appendBufferUint32(b, tRecord.mFileSize);
+	appendBufferUint32(b, tRecord.mModificationTime);
+	appendBufferUint32(b, tRecord.mContentHash);
+	appendRosterIndexString(b, tRecord.mEntry.mDisplayName);
+	appendRosterIndexString(b, tRecord.mEntry.mName);
+	appendRosterIndexString(b, tRecord.mEntry.mAuthorName);
+	appendRosterIndexString(b, tRecord.mEntry.mVersionDate);
+	appendRosterIndexString(b, tRecord.mEntry.mSpritePath);
+	appendBufferInt32(b, tRecord.mEntry.mHasPalettePath);
+	appendRosterIndexString(b, tRecord.mEntry.mPalettePath);
+}
+
+static void resetRosterIndexRequests() {
+	for (auto& record : gRosterIndexData.mRecords) {
+		record.second.mIsInRoster = 0;
+	}
+	gRosterIndexData.mRequestAmount = 0;
+}
+
+static void markRosterIndexRecordRequested(RosterIndexRecord* tRecord) {
+	tRecord->mIsInRoster = 1;
+	gRosterIndexData.mRequestAmount++;
+}
+
+static int pruneRosterIndexRecordsNotInRoster() {
+	if (!gRosterIndexData.mRequestAmount) return 0; // the roster was not walked, e.g. while character scripts are skipped
+
+	int hasPruned = 0;
+	for (auto it = gRosterIndexData.mRecords.begin(); it != gRosterIndexData.mRecords.end();) {
+		if (!it->second.mIsInRoster) {
+			it = gRosterIndexData.mRecords.erase(it);
+			hasPruned = 1;
+		}
+		else ++it;
+	}
+	return hasPruned;
+}
+
+void loadRosterIndex()
+{
+	resetRosterIndexRequests();
+	if (gRosterIndexData.mIsLoaded) return;
+	gRosterIndexData.mIsLoaded = 1;
+	gRosterIndexData.mHasChanged = 0;
+
+	const auto path = getRosterIndexPath();
+	if (!isFile(path)) return;
+
+	auto b = fileToBuffer(path.c_str());
+	auto p = getBufferPointer(b);
+	const auto end = p + b.mLength;
+
+	uint32_t version = 0;
+	if (!readRosterIndexValue(&version, &p, end, sizeof(uint32_t)) || version != ROSTER_INDEX_VERSION) {
+		logWarningFormat("Roster index %s has invalid version: %d. Rebuilding.", path.c_str(), version);
+		freeBuffer(b);
+		return;
+	}
+
+	uint32_t recordAmount = 0;
+	int isValid = readRosterIndexValue(&recordAmount, &p, end, sizeof(uint32_t));
+	for (uint32_t i = 0; isValid && i < recordAmount; i++) {
+		isValid = readRosterIndexRecord(&p, end);
+	}
+	freeBuffer(b);
+	if (!isValid) {
+		logWarningFormat("Roster index %s is truncated. Rebuilding.", path.c_str());
+		gRosterIndexData.mRecords.clear();
+		return;
+	}
+	logFormat("Loaded roster index with %d characters.", int(recordAmount));
+}
+
+void saveRosterIndex()
+{
+	if (pruneRosterIndexRecordsNotInRoster()) gRosterIndexData.mHasChanged = 1;
+	if (!gRosterIndexData.mHasChanged) return;
+	gRosterIndexData.mHasChanged = 0;
+#ifndef DREAMCAST
+	Buffer b = makeBufferEmptyOwned();
+	appendBufferUint32(&b, ROSTER_INDEX_VERSION);
+	appendBufferUint32(&b, uint32_t(gRosterIndexData.mRecords.size()));
+	for (const auto& record : gRosterIndexData.mRecords) {
+		writeRosterIndexRecord(&b, record.first, record.second);
+	}
+	bufferToFile(getRosterIndexPath().c_str(), b);
+	freeBuffer(b);
+#endif
+}
+
+static void loadRosterIndexEntryFromDefinition(RosterIndexEntry* oEntry, const char* tDefinitionPath) {
+	char path[1024];
+	getPathToFile(path, tDefinitionPath);
+
+	MugenDefScript script;
+	loadMugenDefScript(&script, tDefinitionPath);
+	oEntry->mDisplayName = getSTLMugenDefStringVariable(&script, "info", "displayname");
+	oEntry->mName = getSTLMugenDefStringOrDefault(&script, "info", "name", oEntry->mDisplayName.c_str());
+	oEntry->mAuthorName = getSTLMugenDefStringOrDefault(&script, "info", "author", "N/A");
+	oEntry->mVersionDate = getSTLMugenDefStringOrDefault(&script, "info", "versiondate", "N/A");
+
+	const auto palette = getSTLMugenDefStringOrDefault(&script, "files", "pal1", "");
+	oEntry->mHasPalettePath = !palette.empty();
+	oEntry->mPalettePath = std::string(path) + palette;
+
+	const auto sprite = getSTLMugenDefStringOrDefault(&script, "files", "sprite", "");
+	assert(!sprite.empty());
+	oEntry->mSpritePath = std::string(path) + sprite;
+	if (isFile(oEntry->mSpritePath + ROSTER_INDEX_PORTRAITS_SUFFIX)) {
+		oEntry->mSpritePath += ROSTER_INDEX_PORTRAITS_SUFFIX;
+	}
+	unloadMugenDefScript(&script);
+}
+
+static int hasRosterIndexPortraitFileChanged(const RosterIndexEntry& tEntry) {
+	const auto& spritePath = tEntry.mSpritePath;
+	const auto suffixLength = strlen(ROSTER_INDEX_PORTRAITS_SUFFIX);
+	const int isUsingPortraitFile = spritePath.size() > suffixLength && !spritePath.compare(spritePath.size() - suffixLength, suffixLength, ROSTER_INDEX_PORTRAITS_SUFFIX);
+	const auto basePath = isUsingPortraitFile ? spritePath.substr(0, spritePath.size() - suffixLength) : spritePath;
+	return isUsingPortraitFile != int(isFile(basePath + ROSTER_INDEX_PORTRAITS_SUFFIX));
+}
+
+const RosterIndexEntry* getRosterIndexEntry(const char* tDefinitionPath)
+{
+#ifdef DREAMCAST
+	const auto it = gRosterIndexData.mRecords.find(tDefinitionPath);
+	if (it != gRosterIndexData.mRecords.end()) { // the disc cannot change, so the shipped index is trusted
+		markRosterIndexRecordRequested(&it->second);
+		return &it->second.mEntry;
+	}
+	if (!isFile(tDefinitionPath)) return NULL;
+
+	auto& record = gRosterIndexData.mRecords[tDefinitionPath];
+	markRosterIndexRecordRequested(&record);
+	loadRosterIndexEntryFromDefinition(&record.mEntry, tDefinitionPath);
+	return &record.mEntry;
+#else
+	uint32_t fileSize, modificationTime;
+	if (!getRosterIndexFileStat(tDefinitionPath, &fileSize, &modificationTime)) {
+		return NULL;
+	}
+
+	auto& record = gRosterIndexData.mRecords[tDefinitionPath];
+	markRosterIndexRecordRequested(&record);
+	const auto hasPortraitFileChanged = hasRosterIndexPortraitFileChanged(record.mEntry);
+	if (record.mFileSize == fileSize && record.mModificationTime == modificationTime && !hasPortraitFileChanged) {
+		return &record.mEntry;
+	}
+
+	const auto contentHash = getRosterIndexContentHash(tDefinitionPath);
+	if (record.mFileSize != fileSize || record.mContentHash != contentHash || hasPortraitFileChanged) {
+		loadRosterIndexEntryFromDefinition(&record.mEntry, tDefinitionPath);
+		record.mFileSize = fileSize;
+		record.mContentHash = contentHash;
+	}
+	record.mModificationTime = modificationTime;
+	gRosterIndexData.mHasChanged = 1;
+	return &record.mEntry;
+#endif
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+
+typedef struct {
+	std::string mDisplayName;
+	std::string mName;
+	std::string mAuthorName;
+	std::string mVersionDate;
+
+	std::string mSpritePath;
+	int mHasPalettePath;
+	std::string mPalettePath;
+} RosterIndexEntry;
+
+void loadRosterIndex();
+void saveRosterIndex();
+const RosterIndexEntry* getRosterIndexEntry(const char* tDefinitionPath);
@@ -623,6 +623,12 @@ void setDreamStageMugenDefinition(const char * tPath, const char* tCustomMusicPa
 	strcpy(gStageData.mCustomMusicPath, tCustomMusicPath);
 }
 
+void getDreamStageMugenDefinition(char* tDstPath, char* tDstCustomMusicPath)
+{
+	strcpy(tDstPath, gStageData.mDefinitionPath);
+	strcpy(tDstCustomMusicPath, gStageData.mCustomMusicPath);
+}
+
 MugenAnimations * getStageAnimations()
 {
 	return &gStageData.mAnimations;
@@ -15,6 +15,7 @@ using namespace prism;
 
 void loadBackgroundElementGroup(MugenDefScriptGroup* tGroup, int i, MugenSpriteFile* tSprites, MugenAnimations* tAnimations, const Vector2DI& tLocalCoordinates, const Vector2D& tGlobalScale);
 void setDreamStageMugenDefinition(const char* tPath, const char* tCustomMusicPath);
+void getDreamStageMugenDefinition(char* tDstPath, char* tDstCustomMusicPath);
 ActorBlueprint getDreamStageBP();
 
 MugenAnimations* getStageAnimations();
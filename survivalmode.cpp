@@ -1,6 +1,7 @@
 #include "survivalmode.h"
 
 #include <assert.h>
+#include <random>
 
 #include <prism/mugendefreader.h>
 #include <prism/math.h>
@@ -17,6 +18,7 @@
 #include "fightui.h"
 #include "fightresultdisplay.h"
 #include "config.h"
+#include "matchprefetch.h"
 
 static struct {
 	int mCurrentEnemy;
@@ -25,6 +27,10 @@ static struct {
 	int mRoundsToWin;
 
 	double mLifePercentage;
+
+	int mHasNextEnemy;
+	char mNextEnemyPath[1024]; // picked a fight early so its files can be prefetched
+	std::minstd_rand mEnemyRandom; // seeded once per run, so picking ahead does not draw from the fight RNG
 } gSurvivalModeData;
 
 static void updateSurvivalResultMessage() {
@@ -55,12 +61,22 @@ static void updateSurvivalResultIsShowingWinPose() {
 	setFightResultIsShowingWinPose(gSurvivalModeData.mCurrentEnemy >= gSurvivalModeData.mRoundsToWin);
 }
 
-static void updateSurvivalEnemy() {
+static void pickNextSurvivalEnemy() {
 	MugenDefScript script;
 	loadMugenDefScript(&script, getDolmexicaAssetFolder() + "data/select.def");
-	setCharacterRandomAndReturnIfSuccessful(&script, 1);
+	gSurvivalModeData.mHasNextEnemy = getCharacterRandomPathAndReturnIfSuccessful(&script, gSurvivalModeData.mNextEnemyPath, int(gSurvivalModeData.mEnemyRandom()));
+	unloadMugenDefScript(&script);
 }
 
+static void updateSurvivalEnemy() {
+	if (!gSurvivalModeData.mHasNextEnemy) return;
+	setPlayerDefinitionPath(1, gSurvivalModeData.mNextEnemyPath);
+
+	pickNextSurvivalEnemy();
+	if (gSurvivalModeData.mHasNextEnemy) {
+		armMatchPrefetch(gSurvivalModeData.mNextEnemyPath, NULL);
+	}
+}
 
 static void fightFinishedCB() {
 	gSurvivalModeData.mCurrentEnemy++;
@@ -111,6 +127,13 @@ void startSurvivalMode()
 {
 	gSurvivalModeData.mCurrentEnemy = -1;
 	gSurvivalModeData.mLifePercentage = 1;
+	cancelMatchPrefetch();
+	gSurvivalModeData.mEnemyRandom.seed(randfromInteger(1, 0x7FFFFFFE));
+	pickNextSurvivalEnemy();
+	if (gSurvivalModeData.mHasNextEnemy) {
+		armMatchPrefetch(gSurvivalModeData.mNextEnemyPath, NULL);
+		startArmedMatchPrefetch(); // first opponent streams in during character select
+	}
 	setPlayerStartLifePercentage(0, 1);
 
 	loadSurvivalModeHeaderFromScript();
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <prism/wrapper.h>
+#include <prism/file.h>
+#include <prism/debug.h>
+
+#include "characterpackage.h"
+#include "../tools/characterpacker/characterpackagewriter.h"
+
+class CharacterPackageTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		initMemoryHandler();
+	}
+
+	void TearDown() override {
+		unloadCharacterPackage();
+		shutdownMemoryHandler();
+	}
+};
+
+static CharacterPackageWriterEntry makePackageEntry(const char* tName, const char* tContent) {
+	CharacterPackageWriterEntry ret;
+	ret.mName = tName;
+	ret.mContent = tContent;
+	ret.mSourceModificationTime = 0;
+	return ret;
+}
+
+static void writePackage(const char* tPath, const std::string& tPackage) {
+	Buffer b = makeBufferEmptyOwned();
+	appendBufferBuffer(&b, makeBuffer((void*)tPackage.data(), uint32_t(tPackage.size())));
+	bufferToFile(tPath, b);
+	freeBuffer(b);
+}
+
+static std::vector<CharacterPackageWriterEntry> makeTestPackageEntries(const std::string& tDefinitionName) {
+	std::vector<CharacterPackageWriterEntry> ret;
+	ret.push_back(makePackageEntry((tDefinitionName + ".def").c_str(), "[Info]\nname = Packed\n"));
+	ret.push_back(makePackageEntry("States/PackageTest.cns", "[Data]\nlife = 1234\n"));
+	return ret;
+}
+
+TEST_F(CharacterPackageTest, LoadsWhatThePackerWrites) {
+	writePackage("debug/packagetest.def.pak", writeCharacterPackage(makeTestPackageEntries("PackageTest")));
+	loadCharacterPackage("debug/packagetest.def");
+
+	ASSERT_TRUE(isCharacterFile("debug/packagetest.def"));
+	ASSERT_TRUE(isCharacterFile("debug/states\\packagetest.CNS"));
+	ASSERT_FALSE(isCharacterFile("debug/states/missing.cns"));
+
+	MugenDefScript script;
+	loadCharacterMugenDefScript(&script, "debug/packagetest.def");
+	ASSERT_EQ("Packed", getSTLMugenDefStringOrDefault(&script, "info", "name", ""));
+	unloadMugenDefScript(&script);
+
+	loadCharacterMugenDefScript(&script, "debug/states/packagetest.cns");
+	ASSERT_EQ(1234, getMugenDefIntegerOrDefault(&script, "data", "life", 0));
+	unloadMugenDefScript(&script);
+}
+
+TEST_F(CharacterPackageTest, IgnoresTruncatedPackage) {
+	const auto package = writeCharacterPackage(makeTestPackageEntries("PackageTest"));
+	writePackage("debug/packagetest.def.pak", package.substr(0, strlen(CHARACTER_PACKAGE_MAGIC) + 10));
+	loadCharacterPackage("debug/packagetest.def");
+
+	ASSERT_FALSE(isCharacterFile("debug/states/packagetest.cns"));
+}
+
+TEST_F(CharacterPackageTest, IgnoresPackageOlderThanLooseFilesInDevelopMode) {
+	setDevelopMode();
+	writePackage("debug/stalepackagetest.def.pak", writeCharacterPackage(makeTestPackageEntries("StalePackageTest")));
+	writePackage("debug/StalePackageTest.def", "[Info]\nname = Edited loose file\n");
+	loadCharacterPackage("debug/stalepackagetest.def");
+
+	ASSERT_FALSE(isCharacterFile("debug/states/packagetest.cns"));
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include "mugenexplod.h"
+
+static const auto EXPLOD_MOTION_EPSILON = 1e-9;
+
+static void stepExplodMotion(double* ioPosition, double* ioVelocity, double tAcceleration, int tAcceleratedSteps, int tCoastingSteps) {
+	for (int i = 0; i < tAcceleratedSteps; i++) {
+		*ioVelocity += tAcceleration;
+		*ioPosition += *ioVelocity;
+	}
+	for (int i = 0; i < tCoastingSteps; i++) {
+		*ioPosition += *ioVelocity;
+	}
+}
+
+TEST(ExplodMotionTest, ClosedFormMatchesSteps) {
+	static const double VELOCITIES[] = { 0.0, 2.5, -3.25 };
+	static const double ACCELERATIONS[] = { 0.0, 0.5, -0.125 };
+	for (const auto velocity : VELOCITIES) {
+		for (const auto acceleration : ACCELERATIONS) {
+			for (int accelerated = 0; accelerated <= 4; accelerated++) {
+				for (int coasting = 0; coasting <= 3; coasting++) {
+					double closedPosition = 10.0, closedVelocity = velocity;
+					double steppedPosition = 10.0, steppedVelocity = velocity;
+					advanceExplodMotion(&closedPosition, &closedVelocity, acceleration, accelerated, coasting);
+					stepExplodMotion(&steppedPosition, &steppedVelocity, acceleration, accelerated, coasting);
+					ASSERT_NEAR(steppedPosition, closedPosition, EXPLOD_MOTION_EPSILON);
+					ASSERT_NEAR(steppedVelocity, closedVelocity, EXPLOD_MOTION_EPSILON);
+				}
+			}
+		}
+	}
+}
+
+// steps cut short by the owner's hit pause keep moving without accelerating, over several ticks in a row
+TEST(ExplodMotionTest, HitPauseCoastingMatchesSteps) {
+	static const int ACCELERATED_STEPS[] = { 2, 1, 0, 0, 1, 3 };
+	static const int COASTING_STEPS[] = { 0, 1, 2, 2, 0, 0 };
+	double closedPosition = 0.0, closedVelocity = 4.0;
+	double steppedPosition = 0.0, steppedVelocity = 4.0;
+	for (int i = 0; i < 6; i++) {
+		advanceExplodMotion(&closedPosition, &closedVelocity, -0.75, ACCELERATED_STEPS[i], COASTING_STEPS[i]);
+		stepExplodMotion(&steppedPosition, &steppedVelocity, -0.75, ACCELERATED_STEPS[i], COASTING_STEPS[i]);
+		ASSERT_NEAR(steppedPosition, closedPosition, EXPLOD_MOTION_EPSILON);
+		ASSERT_NEAR(steppedVelocity, closedVelocity, EXPLOD_MOTION_EPSILON);
+	}
+}
+
+// a slowed down explod advances its drawn position every tick, on the line between its whole steps
+TEST(ExplodMotionTest, FractionalSpeedMovesEveryTick) {
+	static const auto SPEED = 0.25;
+	static const auto ACCELERATION = 0.5;
+	double position = 0.0, velocity = 2.0, stepFraction = 0.0;
+	double previousDrawPosition = getExplodMotionDrawPosition(position, velocity, ACCELERATION, stepFraction);
+	for (int tick = 0; tick < 16; tick++) {
+		const auto positionBeforeStep = position;
+		const auto velocityBeforeStep = velocity;
+		stepFraction += SPEED;
+		const int steps = (int)stepFraction;
+		stepFraction -= steps;
+		advanceExplodMotion(&position, &velocity, ACCELERATION, steps, 0);
+
+		const auto drawPosition = getExplodMotionDrawPosition(position, velocity, ACCELERATION, stepFraction);
+		ASSERT_GT(drawPosition, previousDrawPosition);
+		if (!steps) {
+			ASSERT_NEAR(positionBeforeStep + (velocityBeforeStep + ACCELERATION) * stepFraction, drawPosition, EXPLOD_MOTION_EPSILON);
+		}
+		else {
+			ASSERT_NEAR(position, drawPosition, EXPLOD_MOTION_EPSILON);
+		}
+		previousDrawPosition = drawPosition;
+	}
+	ASSERT_NEAR(4 * 2.0 + 0.5 * 4 * 5 / 2, position, EXPLOD_MOTION_EPSILON);
+}
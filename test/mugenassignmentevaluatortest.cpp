@@ -2,6 +2,8 @@
 
 #include <prism/wrapper.h>
 #include "mugenassignmentevaluator.h"
+#include "playerhitdata.h"
+#include "playerdefinition.h"
 
 class MugenAssignmentEvaluatorTest : public ::testing::Test {
 protected:
@@ -364,4 +366,134 @@ TEST_F(MugenAssignmentEvaluatorTest, AnimElemTimeArray) {
 	DreamMugenDependOnTwoAssignment* comparison = (DreamMugenDependOnTwoAssignment*)assignment;
 	ASSERT_EQ(comparison->a->mType, MUGEN_ASSIGNMENT_TYPE_ARRAY);
 	ASSERT_EQ(comparison->b->mType, MUGEN_ASSIGNMENT_TYPE_UNARY_MINUS);
-}
\ No newline at end of file
+}
+TEST_F(MugenAssignmentEvaluatorTest, HitDefAttributeCompiledAtParseTime) {
+	auto assignment = parseDreamMugenAssignmentFromString("hitdefattr = SC, NA, SP");
+	ASSERT_EQ(assignment->mType, MUGEN_ASSIGNMENT_TYPE_COMPARISON);
+	DreamMugenDependOnTwoAssignment* comparison = (DreamMugenDependOnTwoAssignment*)assignment;
+	ASSERT_EQ(comparison->a->mType, MUGEN_ASSIGNMENT_TYPE_RAW_VARIABLE);
+	ASSERT_STREQ(MUGEN_COMPILED_HIT_DEF_ATTRIBUTE_VARIABLE_NAME, ((DreamMugenRawVariableAssignment*)comparison->a)->mName);
+	ASSERT_EQ(comparison->b->mType, MUGEN_ASSIGNMENT_TYPE_NUMBER);
+	ASSERT_EQ(compileHitDefAttributeString("SC, NA, SP"), uint32_t(((DreamMugenNumberAssignment*)comparison->b)->mValue));
+
+	assignment = parseDreamMugenAssignmentFromString("p2, hitdefattr != A");
+	ASSERT_EQ(assignment->mType, MUGEN_ASSIGNMENT_TYPE_INEQUALITY);
+	comparison = (DreamMugenDependOnTwoAssignment*)assignment;
+	ASSERT_EQ(comparison->a->mType, MUGEN_ASSIGNMENT_TYPE_VECTOR);
+	const auto redirectedVariable = ((DreamMugenDependOnTwoAssignment*)comparison->a)->b;
+	ASSERT_EQ(redirectedVariable->mType, MUGEN_ASSIGNMENT_TYPE_RAW_VARIABLE);
+	ASSERT_STREQ(MUGEN_COMPILED_HIT_DEF_ATTRIBUTE_VARIABLE_NAME, ((DreamMugenRawVariableAssignment*)redirectedVariable)->mName);
+	ASSERT_EQ(comparison->b->mType, MUGEN_ASSIGNMENT_TYPE_NUMBER);
+	ASSERT_EQ(compileHitDefAttributeString("A"), uint32_t(((DreamMugenNumberAssignment*)comparison->b)->mValue));
+}
+
+TEST_F(MugenAssignmentEvaluatorTest, HitDefAttributeNonLiteralNotCompiled) {
+	auto assignment = parseDreamMugenAssignmentFromString("hitdefattr = var(1)");
+	ASSERT_EQ(assignment->mType, MUGEN_ASSIGNMENT_TYPE_COMPARISON);
+	DreamMugenDependOnTwoAssignment* comparison = (DreamMugenDependOnTwoAssignment*)assignment;
+	ASSERT_NE(comparison->b->mType, MUGEN_ASSIGNMENT_TYPE_NUMBER);
+	ASSERT_EQ(comparison->a->mType, MUGEN_ASSIGNMENT_TYPE_RAW_VARIABLE);
+	ASSERT_STREQ("hitdefattr", ((DreamMugenRawVariableAssignment*)comparison->a)->mName);
+
+	assignment = parseDreamMugenAssignmentFromString("stateno = 200");
+	comparison = (DreamMugenDependOnTwoAssignment*)assignment;
+	ASSERT_EQ(comparison->b->mType, MUGEN_ASSIGNMENT_TYPE_NUMBER);
+	ASSERT_EQ(200, ((DreamMugenNumberAssignment*)comparison->b)->mValue);
+}
+
+TEST_F(MugenAssignmentEvaluatorTest, HitDefAttributeMatching) {
+	const auto hitData = compileHitDefAttributeString("S, NA");
+	ASSERT_TRUE(isHitDefAttributeMatching(compileHitDefAttributeString("SCA, NA, SA"), hitData));
+	ASSERT_FALSE(isHitDefAttributeMatching(compileHitDefAttributeString("SCA, SA, HA"), hitData));
+	ASSERT_FALSE(isHitDefAttributeMatching(compileHitDefAttributeString("CA, NA"), hitData));
+	ASSERT_TRUE(isHitDefAttributeMatching(compileHitDefAttributeString("S"), hitData));
+}
+
+TEST_F(MugenAssignmentEvaluatorTest, HitFlagMatching) {
+	const auto defaultFlags = compileMugenHitFlags("MAF");
+	ASSERT_TRUE(isMugenHitFlagMatching(defaultFlags, MUGEN_STATE_TYPE_STANDING, 0, 0, 0));
+	ASSERT_TRUE(isMugenHitFlagMatching(defaultFlags, MUGEN_STATE_TYPE_CROUCHING, 0, 0, 0));
+	ASSERT_TRUE(isMugenHitFlagMatching(defaultFlags, MUGEN_STATE_TYPE_AIR, 0, 0, 0));
+	ASSERT_TRUE(isMugenHitFlagMatching(defaultFlags, MUGEN_STATE_TYPE_AIR, 1, 1, 0));
+	ASSERT_FALSE(isMugenHitFlagMatching(defaultFlags, MUGEN_STATE_TYPE_LYING, 1, 0, 0));
+
+	const auto highFlags = compileMugenHitFlags("H");
+	ASSERT_TRUE(isMugenHitFlagMatching(highFlags, MUGEN_STATE_TYPE_STANDING, 0, 0, 0));
+	ASSERT_FALSE(isMugenHitFlagMatching(highFlags, MUGEN_STATE_TYPE_CROUCHING, 0, 0, 0));
+	ASSERT_FALSE(isMugenHitFlagMatching(compileMugenHitFlags("A"), MUGEN_STATE_TYPE_AIR, 1, 1, 0));
+	ASSERT_TRUE(isMugenHitFlagMatching(compileMugenHitFlags("D"), MUGEN_STATE_TYPE_LYING, 1, 0, 0));
+}
+
+TEST_F(MugenAssignmentEvaluatorTest, HitFlagGetHitStateRequirements) {
+	const auto comboOnlyFlags = compileMugenHitFlags("MAF+");
+	ASSERT_TRUE(isMugenHitFlagMatching(comboOnlyFlags, MUGEN_STATE_TYPE_STANDING, 1, 0, 0));
+	ASSERT_FALSE(isMugenHitFlagMatching(comboOnlyFlags, MUGEN_STATE_TYPE_STANDING, 0, 0, 0));
+
+	const auto freshOnlyFlags = compileMugenHitFlags("MAF-");
+	ASSERT_TRUE(isMugenHitFlagMatching(freshOnlyFlags, MUGEN_STATE_TYPE_STANDING, 0, 0, 0));
+	ASSERT_FALSE(isMugenHitFlagMatching(freshOnlyFlags, MUGEN_STATE_TYPE_STANDING, 1, 0, 0));
+
+	ASSERT_TRUE(isMugenHitFlagMatching(compileMugenHitFlags("H"), MUGEN_STATE_TYPE_CROUCHING, 0, 0, 1));
+	ASSERT_FALSE(isMugenHitFlagMatching(comboOnlyFlags, MUGEN_STATE_TYPE_STANDING, 0, 0, 1));
+}
+
+TEST_F(MugenAssignmentEvaluatorTest, HitEventsResolveInAttackerOrder) {
+	static DreamPlayer receiver, attackers[3];
+	static PlayerHitEvents events;
+	clearPlayerHitEvents(&events);
+	ASSERT_TRUE(addPlayerHitEvent(&events, &receiver, &attackers[0], &attackers[0].mPassiveHitData, 2));
+	ASSERT_TRUE(addPlayerHitEvent(&events, &receiver, &attackers[1], &attackers[1].mPassiveHitData, 0));
+	ASSERT_TRUE(addPlayerHitEvent(&events, &receiver, &attackers[2], &attackers[2].mPassiveHitData, 2));
+	ASSERT_EQ(3, events.mAmount);
+	ASSERT_EQ(&attackers[1], events.mEvents[0].mAttacker);
+	ASSERT_EQ(&attackers[0], events.mEvents[1].mAttacker);
+	ASSERT_EQ(&attackers[2], events.mEvents[2].mAttacker);
+
+	clearPlayerHitEvents(&events);
+	for (int i = 0; i < PLAYER_HIT_EVENT_CAPACITY; i++) {
+		ASSERT_TRUE(addPlayerHitEvent(&events, &receiver, &attackers[0], &attackers[0].mPassiveHitData, i));
+	}
+	ASSERT_FALSE(addPlayerHitEvent(&events, &receiver, &attackers[0], &attackers[0].mPassiveHitData, 0));
+}
+
+TEST_F(MugenAssignmentEvaluatorTest, HitEventsKeepTradedHitData) {
+	static DreamPlayer p1, p2;
+	static PlayerHitEvents events;
+	p1.mPassiveHitData.mIsActive = p2.mPassiveHitData.mIsActive = 1;
+	p1.mHelperIDInStore = p2.mHelperIDInStore = -1;
+	p1.mPassiveHitData.mPlayer = getPlayerReference(&p1);
+	p2.mPassiveHitData.mPlayer = getPlayerReference(&p2);
+	p1.mPassiveHitData.mPriority = 4;
+	p2.mPassiveHitData.mPriority = 6;
+
+	// both attacks connect in the same tick, receiving each one deactivates the attacker's hit data
+	clearPlayerHitEvents(&events);
+	ASSERT_TRUE(addPlayerHitEvent(&events, &p2, &p1, &p1.mPassiveHitData, 0));
+	setReceivedHitDataInactive(&p1.mPassiveHitData);
+	ASSERT_TRUE(addPlayerHitEvent(&events, &p1, &p2, &p2.mPassiveHitData, 1 << 24));
+	setReceivedHitDataInactive(&p2.mPassiveHitData);
+
+	// player 1 resolves first, and its hit state drops the reversal and hit flags before player 2 resolves
+	copyHitEventDataToActive(&p1, events.mEvents[1]);
+	p1.mPassiveHitData.mReversalDef.mIsActive = 0;
+	copyHitEventDataToActive(&p2, events.mEvents[0]);
+
+	ASSERT_TRUE(p1.mActiveHitData.mIsActive);
+	ASSERT_EQ(&p2, getReferencedPlayer(p1.mActiveHitData.mPlayer));
+	ASSERT_EQ(6, p1.mActiveHitData.mPriority);
+	ASSERT_TRUE(p2.mActiveHitData.mIsActive);
+	ASSERT_EQ(&p1, getReferencedPlayer(p2.mActiveHitData.mPlayer));
+	ASSERT_EQ(4, p2.mActiveHitData.mPriority);
+}
+
+TEST_F(MugenAssignmentEvaluatorTest, HelperReferencesOnlyResolveWhileTheirSlotIsUsed) {
+	static DreamPlayer root, helper;
+	root.mHelperIDInStore = -1;
+	ASSERT_EQ(&root, getReferencedPlayer(getPlayerReference(&root)));
+
+	// the slot was freed or never allocated, so whatever lives at the address now is not the referenced helper
+	helper.mHelperIDInStore = 3;
+	const auto reference = getPlayerReference(&helper);
+	ASSERT_FALSE(getReferencedPlayer(reference));
+	ASSERT_FALSE(isPlayerReferenceTo(reference, &helper));
+}
@@ -0,0 +1,243 @@
+#include <gtest/gtest.h>
+
+#include <prism/wrapper.h>
+
+#include "commontestfunctionality.h"
+
+#include "config.h"
+#include "netplaylogic.h"
+#include "fightnetplay.h"
+#include "playerdefinition.h"
+#include "stage.h"
+#include "gamelogic.h"
+#include "fightscreen.h"
+#include "fightreplay.h"
+
+class NetplayLoopbackTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		initMemoryHandler();
+	}
+
+	void TearDown() override {
+		stopDolmexicaNetplayLoopback();
+		shutdownMemoryHandler();
+	}
+};
+
+static DolmexicaNetplayLoopbackSettings makeLoopbackSettings(int tDelay, int tJitter, double tReorderProbability, double tLossProbability) {
+	DolmexicaNetplayLoopbackSettings ret;
+	ret.mDelay = tDelay;
+	ret.mJitter = tJitter;
+	ret.mReorderProbability = tReorderProbability;
+	ret.mLossProbability = tLossProbability;
+	ret.mSeed = 1234;
+	return ret;
+}
+
+static void sendLoopbackValue(uint32_t tValue) {
+	Buffer b = makeBufferEmptyOwned();
+	appendBufferUint32(&b, tValue);
+	sendDolmexicaNetplayData(b);
+	freeBuffer(b);
+}
+
+static uint32_t popLoopbackValue() {
+	auto b = popDolmexicaNetplayLoopbackData();
+	auto p = getBufferPointer(b);
+	uint32_t ret;
+	readFromBufferPointer(&ret, &p, sizeof(uint32_t));
+	freeBuffer(b);
+	return ret;
+}
+
+TEST_F(NetplayLoopbackTest, DeliversAfterDelay) {
+	startDolmexicaNetplayLoopback(makeLoopbackSettings(3, 0, 0.0, 0.0));
+	sendLoopbackValue(5);
+	for (int i = 0; i < 2; i++) {
+		updateDolmexicaNetplayLoopback();
+		ASSERT_FALSE(hasDolmexicaNetplayLoopbackData());
+	}
+	updateDolmexicaNetplayLoopback();
+	ASSERT_TRUE(hasDolmexicaNetplayLoopbackData());
+	ASSERT_EQ(5u, popLoopbackValue());
+	ASSERT_FALSE(hasDolmexicaNetplayLoopbackData());
+}
+
+TEST_F(NetplayLoopbackTest, KeepsOrderWithoutReordering) {
+	startDolmexicaNetplayLoopback(makeLoopbackSettings(1, 0, 0.0, 0.0));
+	for (uint32_t i = 0; i < 10; i++) {
+		sendLoopbackValue(i);
+	}
+	updateDolmexicaNetplayLoopback();
+	for (uint32_t i = 0; i < 10; i++) {
+		ASSERT_TRUE(hasDolmexicaNetplayLoopbackData());
+		ASSERT_EQ(i, popLoopbackValue());
+	}
+}
+
+TEST_F(NetplayLoopbackTest, DropsEverythingWithFullLoss) {
+	startDolmexicaNetplayLoopback(makeLoopbackSettings(0, 0, 0.0, 1.0));
+	for (uint32_t i = 0; i < 10; i++) {
+		sendLoopbackValue(i);
+	}
+	updateDolmexicaNetplayLoopback();
+	ASSERT_FALSE(hasDolmexicaNetplayLoopbackData());
+	ASSERT_EQ(10, getDolmexicaNetplayLoopbackDroppedAmount());
+}
+
+TEST_F(NetplayLoopbackTest, JitterStaysWithinBounds) {
+	startDolmexicaNetplayLoopback(makeLoopbackSettings(2, 4, 0.0, 0.0));
+	for (uint32_t i = 0; i < 20; i++) {
+		sendLoopbackValue(i);
+	}
+	for (int i = 0; i < 2; i++) {
+		updateDolmexicaNetplayLoopback();
+		ASSERT_FALSE(hasDolmexicaNetplayLoopbackData());
+	}
+	for (int i = 0; i < 4; i++) {
+		updateDolmexicaNetplayLoopback();
+	}
+	int receivedAmount = 0;
+	while (hasDolmexicaNetplayLoopbackData()) {
+		popLoopbackValue();
+		receivedAmount++;
+	}
+	ASSERT_EQ(20, receivedAmount);
+}
+
+TEST_F(NetplayLoopbackTest, HandsOnReorderedPacketsInSendOrder) {
+	startDolmexicaNetplayLoopback(makeLoopbackSettings(2, 3, 1.0, 0.0));
+	for (uint32_t i = 0; i < 10; i++) {
+		sendLoopbackValue(i);
+	}
+	for (int i = 0; i < 6; i++) {
+		updateDolmexicaNetplayLoopback();
+	}
+	for (uint32_t i = 0; i < 10; i++) {
+		ASSERT_TRUE(hasDolmexicaNetplayLoopbackData());
+		ASSERT_EQ(i, popLoopbackValue());
+	}
+}
+
+TEST_F(NetplayLoopbackTest, SkipsLostPacketsWithoutStalling) {
+	startDolmexicaNetplayLoopback(makeLoopbackSettings(1, 0, 0.0, 0.5));
+	for (uint32_t i = 0; i < 20; i++) {
+		sendLoopbackValue(i);
+	}
+	updateDolmexicaNetplayLoopback();
+	uint32_t previousValue = 0;
+	int receivedAmount = 0;
+	while (hasDolmexicaNetplayLoopbackData()) {
+		const auto value = popLoopbackValue();
+		if (receivedAmount) ASSERT_GT(value, previousValue);
+		previousValue = value;
+		receivedAmount++;
+	}
+	ASSERT_EQ(20, receivedAmount + getDolmexicaNetplayLoopbackDroppedAmount());
+}
+
+class NetplayLoopbackFightTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		setupTestForScreenTestInAssetsFolder();
+	}
+
+	void TearDown() override {
+		stopDolmexicaNetplayLoopback();
+		tearDownTestForScreenTestInAssetsFolder();
+	}
+};
+
+static const auto NETPLAY_LOOPBACK_FIGHT_ITERATIONS = 60 * 20;
+
+static void appendReplayString(Buffer* b, const std::string& tString) {
+	appendBufferUint32(b, uint32_t(tString.size()));
+	appendBufferString(b, tString.c_str(), int(tString.size()));
+}
+
+// scripted inputs for both players, changed every few frames; from tDivergenceFrame on player 1 only holds right
+static void writeLoopbackReplay(const char* tPath, int tDivergenceFrame) {
+	static const uint32_t masks[] = { 0, 1 << 7, 1 << 8, 1 << 10, 1 << 0, 1 << 1, 1 << 3, (1 << 8) | (1 << 0), (1 << 10) | (1 << 4) };
+	static const auto maskAmount = sizeof(masks) / sizeof(masks[0]);
+
+	Buffer b = makeBufferEmptyOwned();
+	appendBufferUint32(&b, 1);
+	appendBufferUint32(&b, 4321);
+	for (int i = 0; i < 2; i++) {
+		appendReplayString(&b, getDolmexicaAssetFolder() + "chars/kfm/kfm.def");
+		appendBufferInt32(&b, i + 1);
+	}
+	appendReplayString(&b, getDolmexicaAssetFolder() + "stages/kfm.def");
+	appendReplayString(&b, "");
+	appendBufferInt32(&b, getDifficulty());
+	appendBufferInt32(&b, getLifeStartPercentageNumber());
+	appendBufferInt32(&b, 1);
+	appendBufferInt32(&b, getGlobalTimerDuration());
+	appendBufferInt32(&b, getGlobalGameSpeed());
+
+	appendBufferUint32(&b, NETPLAY_LOOPBACK_FIGHT_ITERATIONS);
+	uint32_t randomState = 99;
+	uint32_t currentMasks[2] = { 0, 0 };
+	for (int frame = 0; frame < NETPLAY_LOOPBACK_FIGHT_ITERATIONS; frame++) {
+		if (!(frame % 8)) {
+			for (int i = 0; i < 2; i++) {
+				randomState = randomState * 1664525u + 1013904223u;
+				currentMasks[i] = masks[(randomState >> 16) % maskAmount];
+			}
+		}
+		appendBufferUint32(&b, frame >= tDivergenceFrame ? 1 << 8 : currentMasks[0]);
+		appendBufferUint32(&b, currentMasks[1]);
+	}
+	bufferToFile(tPath, b);
+	freeBuffer(b);
+}
+
+static void runLoopbackReplayFight(const char* tReplayPath) {
+	initForAutomatedFightScreenTest();
+	setGameModeNetplay(1);
+	ASSERT_TRUE(loadFightReplay(tReplayPath));
+	const auto screen = getDreamFightScreenForTesting();
+	initPrismWrapperScreenForDebug(screen);
+	updatePrismWrapperScreenForDebugWithIterations(NETPLAY_LOOPBACK_FIGHT_ITERATIONS);
+}
+
+// both instances play the same recorded inputs, the second one checks its state against the first one's sync data
+TEST_F(NetplayLoopbackFightTest, StaysInSyncWithRecordedPeer) {
+	const auto replayPath = std::string("debug/loopback_peer.replay");
+	writeLoopbackReplay(replayPath.c_str(), NETPLAY_LOOPBACK_FIGHT_ITERATIONS);
+
+	startDolmexicaNetplayLoopbackRecording();
+	runLoopbackReplayFight(replayPath.c_str());
+	unloadPrismWrapperScreenForDebug();
+
+	startDolmexicaNetplayLoopbackAgainstRecording(makeLoopbackSettings(4, 3, 0.1, 0.05));
+	runLoopbackReplayFight(replayPath.c_str());
+	const auto checkAmount = getFightNetplayLoopbackCheckAmount();
+	const auto failedFrame = getFightNetplayLoopbackFailedCheckFrame();
+	const auto maximumCheckDelay = getFightNetplayLoopbackMaximumCheckDelay();
+	unloadPrismWrapperScreenForDebug();
+
+	ASSERT_GT(checkAmount, NETPLAY_LOOPBACK_FIGHT_ITERATIONS / 20);
+	ASSERT_EQ(-1, failedFrame);
+	ASSERT_GE(maximumCheckDelay, 4);
+}
+
+TEST_F(NetplayLoopbackFightTest, DetectsDivergedInputs) {
+	const auto peerReplayPath = std::string("debug/loopback_peer.replay");
+	const auto localReplayPath = std::string("debug/loopback_local.replay");
+	static const auto DIVERGENCE_FRAME = NETPLAY_LOOPBACK_FIGHT_ITERATIONS / 2;
+	writeLoopbackReplay(peerReplayPath.c_str(), NETPLAY_LOOPBACK_FIGHT_ITERATIONS);
+	writeLoopbackReplay(localReplayPath.c_str(), DIVERGENCE_FRAME);
+
+	startDolmexicaNetplayLoopbackRecording();
+	runLoopbackReplayFight(peerReplayPath.c_str());
+	unloadPrismWrapperScreenForDebug();
+
+	startDolmexicaNetplayLoopbackAgainstRecording(makeLoopbackSettings(2, 0, 0.0, 0.0));
+	runLoopbackReplayFight(localReplayPath.c_str());
+	const auto failedFrame = getFightNetplayLoopbackFailedCheckFrame();
+	unloadPrismWrapperScreenForDebug();
+
+	ASSERT_GE(failedFrame, DIVERGENCE_FRAME);
+}
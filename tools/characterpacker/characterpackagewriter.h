@@ -0,0 +1,55 @@
+#pragma once
+
+// Writes the "<def>.pak" format read by characterpackage.cpp, shared by the packer and the package tests.
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#ifndef CHARACTER_PACKAGE_MAGIC
+#define CHARACTER_PACKAGE_MAGIC "DOLPAK02"
+#define CHARACTER_PACKAGE_ALIGNMENT 2048
+#endif
+
+typedef struct {
+	std::string mName; // relative to the .def, in its original case
+	std::string mContent;
+	uint32_t mSourceModificationTime; // with the content size, lets the game ignore a package older than its loose files
+} CharacterPackageWriterEntry;
+
+static inline void appendCharacterPackageUint32(std::string& oBuffer, uint32_t tValue) {
+	for (int i = 0; i < 4; i++) {
+		oBuffer.push_back(char((tValue >> (8 * i)) & 0xFF));
+	}
+}
+
+static inline uint32_t alignCharacterPackageOffset(uint32_t tOffset) {
+	return (tOffset + CHARACTER_PACKAGE_ALIGNMENT - 1) / CHARACTER_PACKAGE_ALIGNMENT * CHARACTER_PACKAGE_ALIGNMENT;
+}
+
+static inline std::string writeCharacterPackage(const std::vector<CharacterPackageWriterEntry>& tEntries) {
+	uint32_t offset = uint32_t(strlen(CHARACTER_PACKAGE_MAGIC) + sizeof(uint32_t));
+	for (const auto& entry : tEntries) {
+		offset += uint32_t(5 * sizeof(uint32_t) + entry.mName.size());
+	}
+
+	std::string ret = CHARACTER_PACKAGE_MAGIC;
+	appendCharacterPackageUint32(ret, uint32_t(tEntries.size()));
+	for (const auto& entry : tEntries) {
+		offset = alignCharacterPackageOffset(offset);
+		appendCharacterPackageUint32(ret, uint32_t(entry.mName.size()));
+		ret += entry.mName;
+		appendCharacterPackageUint32(ret, offset);
+		appendCharacterPackageUint32(ret, uint32_t(entry.mContent.size()));
+		appendCharacterPackageUint32(ret, uint32_t(entry.mContent.size()));
+		appendCharacterPackageUint32(ret, entry.mSourceModificationTime);
+		offset += uint32_t(entry.mContent.size());
+	}
+
+	for (const auto& entry : tEntries) {
+		ret.resize(alignCharacterPackageOffset(uint32_t(ret.size())), '\0');
+		ret += entry.mContent;
+	}
+	return ret;
+}
@@ -0,0 +1,107 @@
+// Packs a character's script files (.def, .cmd, .cns, .st) into "<def>.pak", read by characterpackage.cpp.
+// Build: g++ -std=c++17 -O2 characterpacker.cpp -o characterpacker
+// Usage: characterpacker <path/to/character.def>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "characterpackagewriter.h"
+
+static std::string toLower(std::string tString) {
+	for (auto& c : tString) {
+		c = (c == '\\') ? '/' : char(tolower(c));
+	}
+	return tString;
+}
+
+static std::string trim(const std::string& tString) {
+	const auto start = tString.find_first_not_of(" \t\r\n");
+	if (start == std::string::npos) return "";
+	const auto end = tString.find_last_not_of(" \t\r\n");
+	return tString.substr(start, end - start + 1);
+}
+
+static std::map<std::string, std::string> readDefinitionFiles(const std::string& tDefinitionPath) {
+	std::map<std::string, std::string> ret;
+	std::ifstream stream(tDefinitionPath);
+	std::string line;
+	bool isInFilesGroup = false;
+	while (std::getline(stream, line)) {
+		line = trim(line.substr(0, line.find(';')));
+		if (line.empty()) continue;
+		if (line[0] == '[') {
+			isInFilesGroup = toLower(line) == "[files]";
+			continue;
+		}
+		if (!isInFilesGroup) continue;
+
+		const auto equalPosition = line.find('=');
+		if (equalPosition == std::string::npos) continue;
+		ret[toLower(trim(line.substr(0, equalPosition)))] = trim(line.substr(equalPosition + 1));
+	}
+	return ret;
+}
+
+static bool readFile(const std::string& tPath, std::string& oContent) {
+	std::ifstream stream(tPath, std::ios::binary);
+	if (!stream) return false;
+	std::stringstream ss;
+	ss << stream.rdbuf();
+	oContent = ss.str();
+	return true;
+}
+
+int main(int argc, char** argv) {
+	if (argc != 2) {
+		fprintf(stderr, "Usage: %s <character.def>\n", argv[0]);
+		return 1;
+	}
+
+	const std::string definitionPath = argv[1];
+	const auto separatorPosition = definitionPath.find_last_of("/\\");
+	const auto folder = separatorPosition == std::string::npos ? std::string() : definitionPath.substr(0, separatorPosition + 1);
+	const auto files = readDefinitionFiles(definitionPath);
+
+	std::vector<std::string> names;
+	names.push_back(definitionPath.substr(folder.size()));
+	for (const auto& file : files) {
+		const auto& key = file.first;
+		const bool isStateFile = key == "cmd" || key == "cns" || key == "stcommon" || (key.size() > 1 && key[0] == 's' && key[1] == 't');
+		if (isStateFile && !file.second.empty()) names.push_back(file.second);
+	}
+
+	std::vector<CharacterPackageWriterEntry> entries;
+	for (const auto& name : names) {
+		CharacterPackageWriterEntry e;
+		struct stat fileStatus;
+		if (!readFile(folder + name, e.mContent) || stat((folder + name).c_str(), &fileStatus)) continue; // e.g. a stcommon that lives in data/
+		bool isDuplicate = false;
+		for (const auto& entry : entries) {
+			isDuplicate |= toLower(entry.mName) == toLower(name);
+		}
+		if (isDuplicate) continue;
+		e.mName = name;
+		e.mSourceModificationTime = uint32_t(fileStatus.st_mtime);
+		entries.push_back(e);
+	}
+
+	const auto package = writeCharacterPackage(entries);
+
+	const auto packagePath = definitionPath + ".pak";
+	std::ofstream out(packagePath, std::ios::binary);
+	out.write(package.data(), package.size());
+	if (!out) {
+		fprintf(stderr, "Unable to write %s\n", packagePath.c_str());
+		return 1;
+	}
+	printf("Packed %d files into %s\n", int(entries.size()), packagePath.c_str());
+	return 0;
+}
@@ -12,6 +12,7 @@
 #include "gamelogic.h"
 #include "fightdebug.h"
 #include "mugenstagehandler.h"
+#include "trainingmoderewind.h"
 
 #define TRAINING_MODE_MENU_BG_Z 80
 #define TRAINING_MODE_MENU_TEXT_Z 81
@@ -25,6 +26,7 @@ enum TrainingModeMode : int {
 
 enum ManualModeOptions : int {
 	MANUAL_MODE_OPTION_MODE = 0,
+	MANUAL_MODE_OPTION_REWIND,
 	MANUAL_MODE_OPTION_AMOUNT,
 };
 
@@ -34,12 +36,14 @@ enum CooperativeModeOptions : int {
 	COOPERATIVE_MODE_OPTION_DUMMY_MODE,
 	COOPERATIVE_MODE_OPTION_DISTANCE,
 	COOPERATIVE_MODE_OPTION_BUTTON_JAM,
+	COOPERATIVE_MODE_OPTION_REWIND,
 	COOPERATIVE_MODE_OPTION_AMOUNT,
 };
 
 enum AIModeOptions : int {
 	AI_MODE_OPTION_MODE = 0,
 	AI_MODE_OPTION_AI_LEVEL,
+	AI_MODE_OPTION_REWIND,
 	AI_MODE_OPTION_AMOUNT,
 };
 
@@ -107,7 +111,7 @@ static void	setSelectedOptionActive();
 static void loadTrainingModeMenu(void*) {
 	setProfilingSectionMarkerCurrentFunction();
 	gTrainingModeMenuData.mBackgroundAnimationElement = playOneFrameAnimationLoop(Vector3D(78, 28, TRAINING_MODE_MENU_BG_Z), getEmptyWhiteTextureReference());
-	setAnimationSize(gTrainingModeMenuData.mBackgroundAnimationElement, Vector3D(164, 124, 1), Vector3D(0, 0, 0));
+	setAnimationSize(gTrainingModeMenuData.mBackgroundAnimationElement, Vector3D(164, 144, 1), Vector3D(0, 0, 0));
 	setAnimationColor(gTrainingModeMenuData.mBackgroundAnimationElement, 0, 0, 0.6);
 	setAnimationTransparency(gTrainingModeMenuData.mBackgroundAnimationElement, 0.7);
 	setAnimationVisibility(gTrainingModeMenuData.mBackgroundAnimationElement, 0);
@@ -180,7 +184,9 @@ static void setManualModeActive() {
 
 	setGeneralModeActive();
 	changeMugenText(gTrainingModeMenuData.mOptionTexts[MANUAL_MODE_OPTION_MODE][0], "Dummy control");
+	changeMugenText(gTrainingModeMenuData.mOptionTexts[MANUAL_MODE_OPTION_REWIND][0], "Rewind");
 	setOptionTextValue(MANUAL_MODE_OPTION_MODE, "Manual");
+	setOptionTextValue(MANUAL_MODE_OPTION_REWIND, TRAINING_MODE_REWIND_OPTION_TEXT);
 }
 
 static const char* getGuardModeText() {
@@ -264,12 +270,14 @@ static void setCooperativeModeActive() {
 	changeMugenText(gTrainingModeMenuData.mOptionTexts[COOPERATIVE_MODE_OPTION_DUMMY_MODE][0], "Dummy mode");
 	changeMugenText(gTrainingModeMenuData.mOptionTexts[COOPERATIVE_MODE_OPTION_DISTANCE][0], "Distance");
 	changeMugenText(gTrainingModeMenuData.mOptionTexts[COOPERATIVE_MODE_OPTION_BUTTON_JAM][0], "Button jam");
+	changeMugenText(gTrainingModeMenuData.mOptionTexts[COOPERATIVE_MODE_OPTION_REWIND][0], "Rewind");
 
 	setOptionTextValue(COOPERATIVE_MODE_OPTION_MODE, "Cooperative");
 	setOptionTextValue(COOPERATIVE_MODE_OPTION_GUARD_MODE, getGuardModeText());
 	setOptionTextValue(COOPERATIVE_MODE_OPTION_DUMMY_MODE, getDummyModeText());
 	setOptionTextValue(COOPERATIVE_MODE_OPTION_DISTANCE, getDistanceText());
 	setOptionTextValue(COOPERATIVE_MODE_OPTION_BUTTON_JAM, getButtonJamText());
+	setOptionTextValue(COOPERATIVE_MODE_OPTION_REWIND, TRAINING_MODE_REWIND_OPTION_TEXT);
 }
 
 static std::string getAILevelText() {
@@ -283,9 +291,11 @@ static void setAIModeActive() {
 	setGeneralModeActive();
 	changeMugenText(gTrainingModeMenuData.mOptionTexts[AI_MODE_OPTION_MODE][0], "Dummy control");
 	changeMugenText(gTrainingModeMenuData.mOptionTexts[AI_MODE_OPTION_AI_LEVEL][0], "AI Level");
+	changeMugenText(gTrainingModeMenuData.mOptionTexts[AI_MODE_OPTION_REWIND][0], "Rewind");
 
 	setOptionTextValue(AI_MODE_OPTION_MODE, "AI");
 	setOptionTextValue(AI_MODE_OPTION_AI_LEVEL, aiLevelText.c_str());
+	setOptionTextValue(AI_MODE_OPTION_REWIND, TRAINING_MODE_REWIND_OPTION_TEXT);
 }
 
 static void setCurrentModeActive() {
@@ -317,6 +327,9 @@ static void changeManualModeMenuOption(int tDelta) {
 	case MANUAL_MODE_OPTION_MODE:
 		changeTrainingModeMenuMode(tDelta);
 		break;
+	case MANUAL_MODE_OPTION_REWIND:
+		rewindTrainingMode(TRAINING_MODE_REWIND_STEP_FRAMES);
+		break;
 	default:
 		assert(false && "Unrecognized manual mode option");
 	}
@@ -360,6 +373,9 @@ static void changeCooperativeModeMenuOption(int tDelta) {
 	case COOPERATIVE_MODE_OPTION_BUTTON_JAM:
 		changeCooperativeModeButtonJam(tDelta);
 		break;
+	case COOPERATIVE_MODE_OPTION_REWIND:
+		rewindTrainingMode(TRAINING_MODE_REWIND_STEP_FRAMES);
+		break;
 	default:
 		assert(false && "Unrecognized cooperative mode option");
 	}
@@ -383,6 +399,9 @@ static void changeAIModeMenuOption(int tDelta) {
 	case AI_MODE_OPTION_AI_LEVEL:
 		changeAIModeAILevel(tDelta);
 		break;
+	case AI_MODE_OPTION_REWIND:
+		rewindTrainingMode(TRAINING_MODE_REWIND_STEP_FRAMES);
+		break;
 	default:
 		assert(false && "Unrecognized AI mode option");
 	}
@@ -0,0 +1,359 @@
+#include "trainingmoderewind.h"
+
+#include <string.h>
+#include <algorithm>
+
+#include <prism/input.h>
+#include <prism/profiling.h>
+#include <prism/log.h>
+
+#include "playerdefinition.h"
+#include "gamelogic.h"
+#include "mugenstatehandler.h"
+#include "mugenexplod.h"
+
+// seconds of history kept and how often a full keyframe is taken; frames in between store the player core and the vars changed since the previous frame.
+// Only the root players are captured, so rewinding only lands on frames where nothing else of theirs was alive.
+#define TRAINING_REWIND_FRAME_AMOUNT 300
+#define TRAINING_REWIND_KEYFRAME_INTERVAL 30
+#define TRAINING_REWIND_KEYFRAME_AMOUNT (TRAINING_REWIND_FRAME_AMOUNT / TRAINING_REWIND_KEYFRAME_INTERVAL + 1)
+#define TRAINING_REWIND_MAX_CHANGED_VARS 8
+
+struct TrainingRewindPlayerCore {
+	Vector2D mPosition;
+	Vector2D mVelocity;
+	int mState;
+	int mTimeInState;
+	DreamMugenStateType mStateType;
+	DreamMugenStateMoveType mMoveType;
+	DreamMugenStatePhysics mPhysics;
+	int mAnimation;
+	int mAnimationStep;
+	int mIsPlayer2Animation;
+	int mIsInControl;
+	int mIsFacingRight;
+	int mLife;
+	int mPower;
+
+	int mIsHitOver;
+	int mIsFalling;
+	int mIsLyingDown;
+	int mLyingDownTime;
+	int mIsHitPaused;
+	int mHitPauseNow;
+	int mHitPauseDuration;
+	int mIsHitShakeActive;
+	int mHitShakeNow;
+	int mHitShakeDuration;
+	int mIsHitOverWaitActive;
+	int mHitOverNow;
+	int mHitOverDuration;
+};
+
+struct TrainingRewindPlayerVars {
+	int mVars[100];
+	double mFloatVars[100];
+	int mSystemVars[100];
+	double mSystemFloatVars[100];
+};
+
+typedef enum {
+	TRAINING_REWIND_VAR_TYPE_VAR,
+	TRAINING_REWIND_VAR_TYPE_FLOAT_VAR,
+	TRAINING_REWIND_VAR_TYPE_SYSTEM_VAR,
+	TRAINING_REWIND_VAR_TYPE_SYSTEM_FLOAT_VAR,
+} TrainingRewindVarType;
+
+struct TrainingRewindChangedVar {
+	uint8_t mType;
+	uint8_t mIndex;
+	double mValue;
+};
+
+struct TrainingRewindPlayerDelta {
+	TrainingRewindPlayerCore mCore;
+	int mChangedVarAmount;
+	TrainingRewindChangedVar mChangedVars[TRAINING_REWIND_MAX_CHANGED_VARS];
+};
+
+struct TrainingRewindFrame {
+	int mKeyframeSequence;
+	int mIsRewindable;
+	TrainingRewindPlayerDelta mPlayers[2];
+};
+
+static struct {
+	TrainingRewindPlayerVars mKeyframes[TRAINING_REWIND_KEYFRAME_AMOUNT][2];
+	int mNewestKeyframeSequence;
+	int mKeyframeAmount;
+	int mFramesSinceKeyframe;
+	TrainingRewindPlayerVars mPreviousVars[2];
+
+	TrainingRewindFrame mFrames[TRAINING_REWIND_FRAME_AMOUNT];
+	int mFrameStart;
+	int mFrameAmount;
+} gTrainingModeRewindData;
+
+static void loadTrainingModeRewindHandler(void*) {
+	setProfilingSectionMarkerCurrentFunction();
+	gTrainingModeRewindData.mNewestKeyframeSequence = -1;
+	gTrainingModeRewindData.mKeyframeAmount = 0;
+	gTrainingModeRewindData.mFramesSinceKeyframe = 0;
+	gTrainingModeRewindData.mFrameStart = 0;
+	gTrainingModeRewindData.mFrameAmount = 0;
+}
+
+static TrainingRewindPlayerCore captureTrainingRewindPlayerCore(DreamPlayer* p) {
+	const auto coordinateP = getPlayerCoordinateP(p);
+	TrainingRewindPlayerCore ret;
+	ret.mPosition = getPlayerPosition(p, coordinateP);
+	ret.mVelocity = Vector2D(getPlayerVelocityX(p, coordinateP), getPlayerVelocityY(p, coordinateP));
+	ret.mState = getPlayerState(p);
+	ret.mTimeInState = getPlayerTimeInState(p);
+	ret.mStateType = getPlayerStateType(p);
+	ret.mMoveType = getPlayerStateMoveType(p);
+	ret.mPhysics = getPlayerPhysics(p);
+	ret.mAnimation = getPlayerAnimationNumber(p);
+	ret.mAnimationStep = getPlayerAnimationStep(p);
+	ret.mIsPlayer2Animation = p->mActiveAnimations != &p->mHeader->mFiles.mAnimations;
+	ret.mIsInControl = getPlayerControl(p);
+	ret.mIsFacingRight = getPlayerIsFacingRight(p);
+	ret.mLife = getPlayerLife(p);
+	ret.mPower = getPlayerPower(p);
+
+	ret.mIsHitOver = p->mIsHitOver;
+	ret.mIsFalling = p->mIsFalling;
+	ret.mIsLyingDown = p->mIsLyingDown;
+	ret.mLyingDownTime = p->mLyingDownTime;
+	ret.mIsHitPaused = p->mIsHitPaused;
+	ret.mHitPauseNow = p->mHitPauseNow;
+	ret.mHitPauseDuration = p->mHitPauseDuration;
+	ret.mIsHitShakeActive = p->mIsHitShakeActive;
+	ret.mHitShakeNow = p->mHitShakeNow;
+	ret.mHitShakeDuration = p->mHitShakeDuration;
+	ret.mIsHitOverWaitActive = p->mIsHitOverWaitActive;
+	ret.mHitOverNow = p->mHitOverNow;
+	ret.mHitOverDuration = p->mHitOverDuration;
+	return ret;
+}
+
+static void captureTrainingRewindPlayerVars(TrainingRewindPlayerVars* tVars, DreamPlayer* p) {
+	memcpy(tVars->mVars, p->mVariables->mVars, sizeof(p->mVariables->mVars));
+	memcpy(tVars->mFloatVars, p->mVariables->mFloatVars, sizeof(p->mVariables->mFloatVars));
+	memcpy(tVars->mSystemVars, p->mVariables->mSystemVars, sizeof(p->mVariables->mSystemVars));
+	memcpy(tVars->mSystemFloatVars, p->mVariables->mSystemFloatVars, sizeof(p->mVariables->mSystemFloatVars));
+}
+
+template<typename T>
+static int addTrainingRewindChangedVarsAndReturnIfFits(TrainingRewindPlayerDelta* tDelta, TrainingRewindVarType tType, const T* tVars, const T* tPreviousVars) {
+	for (int i = 0; i < 100; i++) {
+		if (tVars[i] == tPreviousVars[i]) continue;
+		if (tDelta->mChangedVarAmount == TRAINING_REWIND_MAX_CHANGED_VARS) return 0;
+		auto& changedVar = tDelta->mChangedVars[tDelta->mChangedVarAmount++];
+		changedVar.mType = uint8_t(tType);
+		changedVar.mIndex = uint8_t(i);
+		changedVar.mValue = double(tVars[i]);
+	}
+	return 1;
+}
+
+static int captureTrainingRewindPlayerDeltaAndReturnIfFits(TrainingRewindPlayerDelta* tDelta, TrainingRewindPlayerVars* tPreviousVars, DreamPlayer* p) {
+	tDelta->mCore = captureTrainingRewindPlayerCore(p);
+	tDelta->mChangedVarAmount = 0;
+	if (!addTrainingRewindChangedVarsAndReturnIfFits(tDelta, TRAINING_REWIND_VAR_TYPE_VAR, p->mVariables->mVars, tPreviousVars->mVars)) return 0;
+	if (!addTrainingRewindChangedVarsAndReturnIfFits(tDelta, TRAINING_REWIND_VAR_TYPE_FLOAT_VAR, p->mVariables->mFloatVars, tPreviousVars->mFloatVars)) return 0;
+	if (!addTrainingRewindChangedVarsAndReturnIfFits(tDelta, TRAINING_REWIND_VAR_TYPE_SYSTEM_VAR, p->mVariables->mSystemVars, tPreviousVars->mSystemVars)) return 0;
+	if (!addTrainingRewindChangedVarsAndReturnIfFits(tDelta, TRAINING_REWIND_VAR_TYPE_SYSTEM_FLOAT_VAR, p->mVariables->mSystemFloatVars, tPreviousVars->mSystemFloatVars)) return 0;
+	captureTrainingRewindPlayerVars(tPreviousVars, p);
+	return 1;
+}
+
+static void applyTrainingRewindPlayerDeltaVars(TrainingRewindPlayerVars* tVars, const TrainingRewindPlayerDelta* tDelta) {
+	for (int i = 0; i < tDelta->mChangedVarAmount; i++) {
+		const auto& changedVar = tDelta->mChangedVars[i];
+		switch (changedVar.mType) {
+		case TRAINING_REWIND_VAR_TYPE_VAR:
+			tVars->mVars[changedVar.mIndex] = int(changedVar.mValue);
+			break;
+		case TRAINING_REWIND_VAR_TYPE_FLOAT_VAR:
+			tVars->mFloatVars[changedVar.mIndex] = changedVar.mValue;
+			break;
+		case TRAINING_REWIND_VAR_TYPE_SYSTEM_VAR:
+			tVars->mSystemVars[changedVar.mIndex] = int(changedVar.mValue);
+			break;
+		default:
+			tVars->mSystemFloatVars[changedVar.mIndex] = changedVar.mValue;
+			break;
+		}
+	}
+}
+
+// helpers, projectiles, explods and target links are not part of the capture, so frames with any of them alive are only kept for the var chain
+static int isTrainingRewindPlayerRestorable(DreamPlayer* p) {
+	return !getPlayerHelperAmount(p) && !getPlayerProjectileAmount(p) && !getExplodAmount(p) && !getPlayerTargetAmount(p);
+}
+
+static TrainingRewindPlayerVars* getTrainingRewindKeyframe(int tSequence, int tPlayerIndex) {
+	return &gTrainingModeRewindData.mKeyframes[tSequence % TRAINING_REWIND_KEYFRAME_AMOUNT][tPlayerIndex];
+}
+
+static TrainingRewindFrame* getTrainingRewindFrame(int tIndex) {
+	return &gTrainingModeRewindData.mFrames[(gTrainingModeRewindData.mFrameStart + tIndex) % TRAINING_REWIND_FRAME_AMOUNT];
+}
+
+static int isTrainingRewindKeyframeValid(int tSequence) {
+	return gTrainingModeRewindData.mNewestKeyframeSequence - tSequence < gTrainingModeRewindData.mKeyframeAmount;
+}
+
+static void addTrainingRewindKeyframe() {
+	gTrainingModeRewindData.mNewestKeyframeSequence++;
+	gTrainingModeRewindData.mKeyframeAmount = std::min(gTrainingModeRewindData.mKeyframeAmount + 1, TRAINING_REWIND_KEYFRAME_AMOUNT);
+
+	for (int i = 0; i < 2; i++) {
+		captureTrainingRewindPlayerVars(getTrainingRewindKeyframe(gTrainingModeRewindData.mNewestKeyframeSequence, i), getRootPlayer(i));
+		captureTrainingRewindPlayerVars(&gTrainingModeRewindData.mPreviousVars[i], getRootPlayer(i));
+	}
+	gTrainingModeRewindData.mFramesSinceKeyframe = 0;
+}
+
+static int captureTrainingRewindFrameAndReturnIfFits(TrainingRewindFrame* tFrame) {
+	tFrame->mKeyframeSequence = gTrainingModeRewindData.mNewestKeyframeSequence;
+	tFrame->mIsRewindable = isTrainingRewindPlayerRestorable(getRootPlayer(0)) && isTrainingRewindPlayerRestorable(getRootPlayer(1));
+	for (int i = 0; i < 2; i++) {
+		if (!captureTrainingRewindPlayerDeltaAndReturnIfFits(&tFrame->mPlayers[i], &gTrainingModeRewindData.mPreviousVars[i], getRootPlayer(i))) return 0;
+	}
+	return 1;
+}
+
+// the deltas of the remaining frames build on the dropped one, so its changes move into the shared keyframe
+static void removeOldestTrainingRewindFrame() {
+	const auto oldestFrame = getTrainingRewindFrame(0);
+	if (isTrainingRewindKeyframeValid(oldestFrame->mKeyframeSequence)) {
+		for (int i = 0; i < 2; i++) {
+			applyTrainingRewindPlayerDeltaVars(getTrainingRewindKeyframe(oldestFrame->mKeyframeSequence, i), &oldestFrame->mPlayers[i]);
+		}
+	}
+	gTrainingModeRewindData.mFrameStart = (gTrainingModeRewindData.mFrameStart + 1) % TRAINING_REWIND_FRAME_AMOUNT;
+	gTrainingModeRewindData.mFrameAmount--;
+}
+
+static void removeTrainingRewindFramesWithStaleKeyframes() {
+	while (gTrainingModeRewindData.mFrameAmount) {
+		if (isTrainingRewindKeyframeValid(getTrainingRewindFrame(0)->mKeyframeSequence)) break;
+		gTrainingModeRewindData.mFrameStart = (gTrainingModeRewindData.mFrameStart + 1) % TRAINING_REWIND_FRAME_AMOUNT;
+		gTrainingModeRewindData.mFrameAmount--;
+	}
+}
+
+static void addTrainingRewindFrame() {
+	if (!gTrainingModeRewindData.mKeyframeAmount || gTrainingModeRewindData.mFramesSinceKeyframe >= TRAINING_REWIND_KEYFRAME_INTERVAL) {
+		addTrainingRewindKeyframe();
+	}
+
+	if (gTrainingModeRewindData.mFrameAmount == TRAINING_REWIND_FRAME_AMOUNT) {
+		removeOldestTrainingRewindFrame();
+	}
+	auto frame = getTrainingRewindFrame(gTrainingModeRewindData.mFrameAmount);
+	if (!captureTrainingRewindFrameAndReturnIfFits(frame)) {
+		addTrainingRewindKeyframe();
+		captureTrainingRewindFrameAndReturnIfFits(frame);
+	}
+	gTrainingModeRewindData.mFrameAmount++;
+	gTrainingModeRewindData.mFramesSinceKeyframe++;
+	removeTrainingRewindFramesWithStaleKeyframes();
+}
+
+// state first, since changing it resets the animation, control and physics that are restored afterwards
+static void restoreTrainingRewindPlayer(DreamPlayer* p, const TrainingRewindPlayerVars* tVars, const TrainingRewindPlayerCore* tCore) {
+	const auto& core = *tCore;
+	changePlayerState(p, core.mState);
+	setPlayerStateType(p, core.mStateType);
+	setPlayerStateMoveType(p, core.mMoveType);
+	setPlayerPhysics(p, core.mPhysics);
+	if (core.mIsPlayer2Animation) {
+		changePlayerAnimationToPlayer2AnimationWithStartStep(p, core.mAnimation, core.mAnimationStep + 1);
+	}
+	else {
+		changePlayerAnimationWithStartStep(p, core.mAnimation, core.mAnimationStep + 1);
+	}
+	setDreamRegisteredStateTimeInState(p->mRegisteredStateMachine, core.mTimeInState);
+
+	const auto coordinateP = getPlayerCoordinateP(p);
+	setPlayerPosition(p, core.mPosition, coordinateP);
+	setPlayerVelocityX(p, core.mVelocity.x, coordinateP);
+	setPlayerVelocityY(p, core.mVelocity.y, coordinateP);
+	setPlayerIsFacingRight(p, core.mIsFacingRight);
+	setPlayerLife(p, p, core.mLife);
+	setPlayerPower(p, core.mPower);
+	setPlayerControl(p, core.mIsInControl);
+
+	p->mIsHitOver = core.mIsHitOver;
+	p->mIsFalling = core.mIsFalling;
+	p->mIsLyingDown = core.mIsLyingDown;
+	p->mLyingDownTime = core.mLyingDownTime;
+	p->mIsHitPaused = core.mIsHitPaused;
+	p->mHitPauseNow = core.mHitPauseNow;
+	p->mHitPauseDuration = core.mHitPauseDuration;
+	p->mIsHitShakeActive = core.mIsHitShakeActive;
+	p->mHitShakeNow = core.mHitShakeNow;
+	p->mHitShakeDuration = core.mHitShakeDuration;
+	p->mIsHitOverWaitActive = core.mIsHitOverWaitActive;
+	p->mHitOverNow = core.mHitOverNow;
+	p->mHitOverDuration = core.mHitOverDuration;
+
+	memcpy(p->mVariables->mVars, tVars->mVars, sizeof(p->mVariables->mVars));
+	memcpy(p->mVariables->mFloatVars, tVars->mFloatVars, sizeof(p->mVariables->mFloatVars));
+	memcpy(p->mVariables->mSystemVars, tVars->mSystemVars, sizeof(p->mVariables->mSystemVars));
+	memcpy(p->mVariables->mSystemFloatVars, tVars->mSystemFloatVars, sizeof(p->mVariables->mSystemFloatVars));
+}
+
+void rewindTrainingMode(int tFrameAmount)
+{
+	if (!gTrainingModeRewindData.mFrameAmount) return;
+
+	auto targetIndex = std::max(gTrainingModeRewindData.mFrameAmount - 1 - tFrameAmount, 0);
+	while (targetIndex >= 0 && !getTrainingRewindFrame(targetIndex)->mIsRewindable) {
+		targetIndex--;
+	}
+	if (targetIndex < 0) {
+		logWarning("No frame without helpers, projectiles, explods or targets left to rewind to.");
+		return;
+	}
+	const auto framesToDrop = gTrainingModeRewindData.mFrameAmount - 1 - targetIndex;
+	gTrainingModeRewindData.mFrameAmount = targetIndex + 1;
+	const auto keyframeSequence = getTrainingRewindFrame(targetIndex)->mKeyframeSequence;
+	auto firstIndex = targetIndex;
+	while (firstIndex > 0 && getTrainingRewindFrame(firstIndex - 1)->mKeyframeSequence == keyframeSequence) {
+		firstIndex--;
+	}
+
+	for (int i = 0; i < 2; i++) {
+		auto& vars = gTrainingModeRewindData.mPreviousVars[i];
+		vars = *getTrainingRewindKeyframe(keyframeSequence, i);
+		for (int j = firstIndex; j <= targetIndex; j++) {
+			applyTrainingRewindPlayerDeltaVars(&vars, &getTrainingRewindFrame(j)->mPlayers[i]);
+		}
+		restoreTrainingRewindPlayer(getRootPlayer(i), &vars, &getTrainingRewindFrame(targetIndex)->mPlayers[i].mCore);
+	}
+
+	gTrainingModeRewindData.mKeyframeAmount -= gTrainingModeRewindData.mNewestKeyframeSequence - keyframeSequence;
+	gTrainingModeRewindData.mNewestKeyframeSequence = keyframeSequence;
+	gTrainingModeRewindData.mFramesSinceKeyframe = targetIndex - firstIndex + 1;
+	logFormat("Training mode rewound %d frames.", framesToDrop);
+}
+
+static void updateTrainingModeRewindHandler(void*) {
+	setProfilingSectionMarkerCurrentFunction();
+
+	if (hasPressedKeyboardKeyFlank(KEYBOARD_F7_PRISM)) {
+		rewindTrainingMode(TRAINING_MODE_REWIND_STEP_FRAMES);
+		return;
+	}
+
+	addTrainingRewindFrame();
+}
+
+ActorBlueprint getTrainingModeRewindHandler()
+{
+	return makeActorBlueprint(loadTrainingModeRewindHandler, NULL, updateTrainingModeRewindHandler);
+}
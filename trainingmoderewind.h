@@ -0,0 +1,11 @@
+#pragma once
+
+#include <prism/actorhandler.h>
+
+using namespace prism;
+
+#define TRAINING_MODE_REWIND_STEP_FRAMES 60
+#define TRAINING_MODE_REWIND_OPTION_TEXT "1s, players only"
+
+ActorBlueprint getTrainingModeRewindHandler();
+void rewindTrainingMode(int tFrameAmount);